@@ -21,8 +21,10 @@
 #define FIFO_H_
 
 #include <stdint.h>
+#include <atomic>
 
 #include "meta/Utility.h"
+#include "managed/OffsetPtr.h"
 
 namespace pet {
 
@@ -77,7 +79,12 @@ namespace pet {
 template<uint16_t size>
 class FifoBase
 {
-    uint16_t readIdx = 0, writeIdx = 0;
+    /*
+     * The indices are read by the other side concurrently (possibly from another
+     * process), so they are always accessed through memory, and the fences keep
+     * the accesses of the data on the right side of the index updates.
+     */
+    volatile uint16_t readIdx = 0, writeIdx = 0;
 public:
     /**
      * Obtain a readable block.
@@ -212,7 +219,9 @@ public:
      * @note This method can be used to implement conditional consumption
      *       of the stored data.
      */
-    inline void commitRead(const Iterator& it) {
+    inline void commitRead(const Iterator& it)
+    {
+        std::atomic_thread_fence(std::memory_order_release);
         readIdx = it.idx;
     }
 };
@@ -268,6 +277,7 @@ inline uint16_t FifoBase<size>::nextReadableIdx(uint16_t &idx) const
      * Amount of data before the end of buffer or the
      * writer pointer, whichever is encountered first.
      */
+    std::atomic_thread_fence(std::memory_order_acquire);
     return  (space > nData) ? nData : space;
 }
 
@@ -305,18 +315,21 @@ inline uint16_t FifoBase<size>::nextWritableIdx(uint16_t &idx) const
      * Amount of data before the end of buffer or the
      * reader pointer, whichever is encountered first.
      */
+    std::atomic_thread_fence(std::memory_order_acquire);
     return  (space > nData) ? nData : space;
 }
 
 template<uint16_t size>
 inline void FifoBase<size>::doneReading(uint16_t length)
 {
+    std::atomic_thread_fence(std::memory_order_release);
     readIdx = (readIdx + length) % (2 * size);
 }
 
 template<uint16_t size>
 inline void FifoBase<size>::doneWriting(uint16_t length)
 {
+    std::atomic_thread_fence(std::memory_order_release);
     writeIdx = (writeIdx + length) % (2 * size);
 }
 
@@ -502,6 +515,40 @@ public:
     inline IndirectFifo(DataType* buffer): buffer(buffer) {}
 };
 
+/**
+ * FIFO with external storage, referred to by a relative pointer.
+ *
+ * Same as the IndirectFifo, but the buffer is referred to by a self-relative
+ * pointer, so the FIFO object and the buffer can be placed in shared memory
+ * that is mapped at different addresses by the reader and writer processes.
+ * Both of them have to be in the same mapped area.
+ *
+ * @see This _fifo_ is based on the FifoBase lock-free index manager.
+ */
+template<uint32_t size, class DataType = char>
+class OffsetFifo: public TypedFifoBase<size, DataType, OffsetFifo<size, DataType>> {
+    typedef TypedFifoBase<size, DataType, OffsetFifo> Base;
+    friend Base;
+
+    OffsetPtr<DataType> buffer;
+
+    inline DataType* getBuffer() {
+        return buffer;
+    }
+
+    inline const DataType* getBuffer() const{
+        return buffer;
+    }
+public:
+    /**
+     * Construct with buffer.
+     *
+     * The address of the external buffer needs to be specified here,
+     * right at construction time.
+     */
+    inline OffsetFifo(DataType* buffer): buffer(buffer) {}
+};
+
 
 }
 #endif /* FIFO_H_ */
@@ -0,0 +1,177 @@
+/*******************************************************************************
+ *
+ * Copyright (c) 2026 Tamás Seller. All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *******************************************************************************/
+
+#ifndef PET_DATA_OFFSETATOMICLIST_H_
+#define PET_DATA_OFFSETATOMICLIST_H_
+
+#include "platform/Atomic.h"
+
+#include <stdint.h>
+
+namespace pet {
+
+/**
+ * Position independent intrusive multi-writer, single-reader linked list.
+ *
+ * Works the same way as the SharedAtomicList, but the links are stored as offsets
+ * relative to the list object, so the list and its elements can be placed in shared
+ * memory, that is mapped at different addresses by the processes using it. The list
+ * object and the elements have to be in the same mapped area.
+ */
+class OffsetAtomicList
+{
+public:
+    /**
+     * Base class for the contained elements.
+     */
+    class Element
+    {
+        /**
+         * Value used in the next field for elements that are not part of any list.
+         */
+        static constexpr intptr_t invalid = -1;
+
+        /**
+         * Offset of the next element from the list object.
+         *
+         * It is set to zero if this is the last element in the list, and to
+         * **invalid** if it is not contained in any list.
+         */
+        pet::Atomic<intptr_t> nextShalElem = invalid;
+
+        /// Access to the next field is provided to the members of the **OffsetAtomicList** class.
+        friend class OffsetAtomicList;
+
+    public:
+        inline Element() = default;
+    };
+
+    class Reader
+    {
+        /// The list, that the offsets are relative to.
+        OffsetAtomicList* list;
+
+        /// The first, next-one-to-be-read element of the re-reversed (original order) list.
+        Element* current;
+
+        /// Construct from pointer to first element (for internal use).
+        inline Reader(OffsetAtomicList* list, Element* current): list(list), current(current) {}
+
+        /// Access to the initializing constructor is provided for **OffsetAtomicList**.
+        friend class OffsetAtomicList;
+
+    public:
+        /// Default move constructor.
+        inline Reader(Reader&&) = default;
+
+        /// Default move assignment operator.
+        inline Reader& operator =(Reader&&) = default;
+
+        /// Get pointer to the next in-order element or null if there is none.
+        really_inline Element* peek() const {
+            return current;
+        }
+
+        /**
+         * Drop the current element.
+         *
+         * NOTE: must not be called of empty, i.e. if _peek_ returns null.
+         */
+        inline void pop() {
+            current = list->at(current->nextShalElem.swap(Element::invalid));
+        }
+    };
+
+private:
+    /// Offset of the first element currently contained in the list (zero if empty).
+    pet::Atomic<intptr_t> first;
+
+    /// Get the element at the offset (zero can not be the offset of an element).
+    really_inline Element* at(intptr_t offset) {
+        return offset ? reinterpret_cast<Element*>(reinterpret_cast<char*>(this) + offset) : nullptr;
+    }
+
+    /// Get the offset of an element.
+    really_inline intptr_t offsetOf(Element* element) {
+        return element ? reinterpret_cast<char*>(element) - reinterpret_cast<char*>(this) : 0;
+    }
+
+public:
+    /**
+     * Insert an element into the list.
+     *
+     * Returns true if the element was inserted, false if it is contained in a
+     * list (which may be another instance then this one).
+     *
+     * @see SharedAtomicList::push for the details of the algorithm.
+     */
+    inline bool push(Element* element)
+    {
+        intptr_t f = first;
+
+        if(!element->nextShalElem.compareAndSwap(Element::invalid, f))
+        {
+            return false;
+        }
+
+        const intptr_t offset = offsetOf(element);
+
+        while(!first.compareAndSwap(f, offset))
+        {
+            f = first;
+            element->nextShalElem = f;
+        }
+
+        return true;
+    }
+
+    /**
+     * Take over current contents of the list and return it as a reader object.
+     *
+     * The elements are returned in the order of insertion.
+     */
+    inline Reader read()
+    {
+        Element* current = at(first.swap(0));
+        Element* prev = nullptr;
+
+        while(current)
+        {
+            Element* oldNext = at(current->nextShalElem);
+            current->nextShalElem = offsetOf(prev);
+            prev = current;
+            current = oldNext;
+        }
+
+        return Reader(this, prev);
+    }
+
+    /**
+     * Check if the list is empty, without taking over its contents.
+     *
+     * NOTE: elements can be pushed concurrently, so the result is only a hint.
+     */
+    really_inline bool isEmpty() {
+        return !(intptr_t)first;
+    }
+};
+
+}
+
+#endif /* PET_DATA_OFFSETATOMICLIST_H_ */
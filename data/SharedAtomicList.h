@@ -115,6 +115,15 @@ public:
 	 * Take over current contents of the list and return it as a reader object.
 	 */
 	Reader read();
+
+	/**
+	 * Check if the list is empty, without taking over its contents.
+	 *
+	 * NOTE: elements can be pushed concurrently, so the result is only a hint.
+	 */
+	really_inline bool isEmpty() {
+		return !(Element*)first;
+	}
 };
 
 }
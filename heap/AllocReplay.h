@@ -0,0 +1,347 @@
+/*******************************************************************************
+ *
+ * Copyright (c) 2026 Tamás Seller. All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *******************************************************************************/
+
+#ifndef PET_HEAP_ALLOCREPLAY_H_
+#define PET_HEAP_ALLOCREPLAY_H_
+
+#include "heap/AllocTrace.h"
+#include "heap/HeapBase.h"
+
+#include "meta/Utility.h"
+#include "platform/Clz.h"
+
+namespace pet {
+
+/**
+ * Latency histogram.
+ *
+ * Counts the samples in logarithmic-then-linear buckets (the same way as the
+ * TlsfPolicy maps the block sizes), so that the relative error of the quantiles
+ * is bounded (to 1/16) while using a small fixed amount of memory.
+ */
+class LatencyHistogram
+{
+    static constexpr uint32_t nSub = 16;
+    static constexpr uint32_t nBuckets = (32 - 3) * nSub;
+
+    uint32_t counts[nBuckets] = {0,};
+    uint32_t total = 0;
+
+    static inline uint32_t bucket(uint32_t v)
+    {
+        if(v < nSub)
+            return v;
+
+        const uint32_t l = 31 - clz(v);
+        return (l - 3) * nSub + ((v >> (l - 4)) & (nSub - 1));
+    }
+
+    static inline uint32_t upperBound(uint32_t idx)
+    {
+        if(idx < nSub)
+            return idx;
+
+        const uint32_t l = idx / nSub + 3;
+        const uint32_t lower = (nSub + idx % nSub) << (l - 4);
+        return lower + ((1u << (l - 4)) - 1);
+    }
+
+public:
+    /// Record a sample.
+    inline void add(uint32_t v)
+    {
+        counts[bucket(v)]++;
+        total++;
+    }
+
+    /**
+     * Get a quantile.
+     *
+     * @param	permyriad The quantile in 1/10000 units (ie. 9990 for p99.9).
+     * @return	The upper bound of the bucket that contains the quantile.
+     */
+    inline uint32_t quantile(uint32_t permyriad) const
+    {
+        const uint64_t target = ((uint64_t)total * permyriad + 9999) / 10000;
+        uint64_t sum = 0;
+
+        for(uint32_t i = 0; i < nBuckets; i++)
+        {
+            sum += counts[i];
+
+            if(sum && target <= sum)
+                return upperBound(i);
+        }
+
+        return 0;
+    }
+};
+
+/**
+ * The results of an allocation trace replay.
+ *
+ * All the time values are in the units of the Clock used for the replay.
+ */
+struct AllocReplayReport
+{
+    uint32_t nOps = 0;              //!< The number of operations executed.
+    uint32_t nFailed = 0;           //!< The number of allocations that failed (but did not in the trace).
+    uint64_t totalTime = 0;         //!< The total time spent in the allocator (throughput is nOps / totalTime).
+    uint32_t p50 = 0;               //!< Median latency.
+    uint32_t p99 = 0;               //!< 99th percentile latency.
+    uint32_t p999 = 0;              //!< 99.9th percentile latency.
+    uintptr_t peakLive = 0;         //!< The maximal total size of the requested amounts of live blocks.
+    uintptr_t peakFootprint = 0;    //!< The size of the address range touched by the allocations.
+    uint32_t fragmentation = 0;     //!< The part of the footprint that is not used even at the peak, in permille.
+};
+
+/**
+ * Allocation trace replay.
+ *
+ * Executes the operations of a recorded allocation trace against an allocator
+ * and measures the time taken by each operation. The addresses in the trace are
+ * mapped to the blocks allocated during the replay by a fixed size hash table,
+ * whose capacity limits the number of blocks that can be live at the same time.
+ *
+ * The allocator has to provide the _alloc(uintptr_t)_, _free(void*)_ and the
+ * _resize(void*, uintptr_t)_ methods (like the Heap), the BuddyReplayAdapter can
+ * be used for the buddy allocators.
+ *
+ * @tparam	Clock Time source, it needs to have a static _now_ method that returns
+ * 			the current time in arbitrary units, as a 32 bit (wrapping) number.
+ * @tparam	maxLive The maximal number of live blocks.
+ */
+template<class Clock, uint32_t maxLive = 4096>
+class AllocReplay: pet::Trace<AllHeapsTrace>
+{
+    static_assert(maxLive > 1, "there must be room for more than one live block");
+    static constexpr uint32_t tableSize = 2u << (32 - clz(maxLive - 1));
+
+    /**
+     * Entry of the address mapping table.
+     *
+     * The _key_ is the encoded address from the trace (which is never zero
+     * for a valid block), zero means unused entry.
+     */
+    struct Entry
+    {
+        uintptr_t key;
+        void* ptr;
+        uintptr_t size;
+    };
+
+    Entry table[tableSize];
+    uint32_t nLive;
+
+    static really_inline uint32_t hash(uintptr_t key) {
+        return (uint32_t)((key * 0x9e3779b97f4a7c15ull) >> 32) & (tableSize - 1);
+    }
+
+    inline Entry* find(uintptr_t key)
+    {
+        for(uint32_t i = hash(key); table[i].key; i = (i + 1) & (tableSize - 1))
+        {
+            if(table[i].key == key)
+                return table + i;
+        }
+
+        return nullptr;
+    }
+
+    inline bool insert(uintptr_t key, void* ptr, uintptr_t size)
+    {
+        if(nLive == maxLive)
+            return false;
+
+        uint32_t i = hash(key);
+
+        while(table[i].key)
+            i = (i + 1) & (tableSize - 1);
+
+        table[i] = {key, ptr, size};
+        nLive++;
+        return true;
+    }
+
+    /// Remove with backward shifting, so that no tombstones are needed.
+    inline void erase(Entry* e)
+    {
+        uint32_t i = e - table;
+
+        for(uint32_t j = (i + 1) & (tableSize - 1); table[j].key; j = (j + 1) & (tableSize - 1))
+        {
+            const uint32_t h = hash(table[j].key);
+
+            if(((j - h) & (tableSize - 1)) >= ((j - i) & (tableSize - 1)))
+            {
+                table[i] = table[j];
+                i = j;
+            }
+        }
+
+        table[i].key = 0;
+        nLive--;
+    }
+
+public:
+    /**
+     * Replay a trace.
+     *
+     * The blocks that are still live at the end of the trace are released (without timing).
+     *
+     * @param	allocator The allocator to be tested.
+     * @param	reader The source of the trace.
+     * @param	histogram Receives the latencies, it is provided by the caller as it is not small.
+     * @return	The measured figures.
+     */
+    template<class Allocator>
+    inline AllocReplayReport run(Allocator &allocator, AllocTraceReader reader, LatencyHistogram &histogram)
+    {
+        AllocReplayReport ret;
+        AllocTraceEvent e;
+
+        for(auto &t: table)
+            t.key = 0;
+
+        nLive = 0;
+
+        uintptr_t live = 0;
+        char *low = nullptr, *high = nullptr;
+
+        while(reader.read(e))
+        {
+            if(e.op == AllocTraceEvent::Op::Alloc)
+            {
+                const uint32_t t0 = Clock::now();
+                void* ptr = allocator.alloc(e.size);
+                const uint32_t dt = Clock::now() - t0;
+
+                histogram.add(dt);
+                ret.totalTime += dt;
+                ret.nOps++;
+
+                if(!e.address)
+                {
+                    if(ptr)
+                        allocator.free(ptr);
+
+                    continue;
+                }
+
+                if(!ptr)
+                {
+                    ret.nFailed++;
+                    continue;
+                }
+
+                const bool ok = insert(e.address, ptr, e.size);
+                assertThat(ok, "AllocReplay: too many live blocks");
+
+                if(!low || ptr < low)
+                    low = static_cast<char*>(ptr);
+
+                if(!high || high < static_cast<char*>(ptr) + e.size)
+                    high = static_cast<char*>(ptr) + e.size;
+
+                if(ret.peakLive < (live += e.size))
+                    ret.peakLive = live;
+            }
+            else if(Entry* entry = find(e.address))
+            {
+                const uint32_t t0 = Clock::now();
+
+                if(e.op == AllocTraceEvent::Op::Free)
+                    allocator.free(entry->ptr);
+                else
+                    allocator.resize(entry->ptr, e.size);
+
+                const uint32_t dt = Clock::now() - t0;
+
+                histogram.add(dt);
+                ret.totalTime += dt;
+                ret.nOps++;
+
+                if(e.op == AllocTraceEvent::Op::Free)
+                {
+                    live -= entry->size;
+                    erase(entry);
+                }
+                else
+                {
+                    live = live - entry->size + e.size;
+                    entry->size = e.size;
+
+                    if(high < static_cast<char*>(entry->ptr) + e.size)
+                        high = static_cast<char*>(entry->ptr) + e.size;
+                }
+            }
+        }
+
+        for(auto &t: table)
+        {
+            if(t.key)
+                allocator.free(t.ptr);
+        }
+
+        ret.peakFootprint = high - low;
+
+        ret.p50 = histogram.quantile(5000);
+        ret.p99 = histogram.quantile(9900);
+        ret.p999 = histogram.quantile(9990);
+
+        if(ret.peakFootprint)
+            ret.fragmentation = 1000 - (uint32_t)((uint64_t)ret.peakLive * 1000 / ret.peakFootprint);
+
+        return ret;
+    }
+};
+
+/**
+ * Adapter to replay traces against a buddy allocator.
+ *
+ * @note	The resize operation is applied by the _adjust_ method of the allocator,
+ * 			if it has one, otherwise it is ignored.
+ */
+template<class Buddy>
+struct BuddyReplayAdapter
+{
+    Buddy &buddy;
+
+    inline void* alloc(uintptr_t size) {
+        return buddy.allocate(size);
+    }
+
+    inline void free(void* ptr) {
+        buddy.free(ptr);
+    }
+
+    template<class B = Buddy>
+    inline auto resize(void* ptr, uintptr_t size) -> decltype(pet::declval<B&>().adjust(ptr, size, pet::declval<uint32_t&>()), void())
+    {
+        uint32_t actual;
+        buddy.adjust(ptr, size, actual);
+    }
+
+    template<class... Args>
+    inline void resize(Args...) {}
+};
+
+}
+
+#endif /* PET_HEAP_ALLOCREPLAY_H_ */
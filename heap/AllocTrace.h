@@ -0,0 +1,253 @@
+/*******************************************************************************
+ *
+ * Copyright (c) 2026 Tamás Seller. All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *******************************************************************************/
+
+#ifndef PET_HEAP_ALLOCTRACE_H_
+#define PET_HEAP_ALLOCTRACE_H_
+
+#include "platform/Compiler.h"
+
+#include <stdint.h>
+
+namespace pet {
+
+/**
+ * Allocation trace event.
+ *
+ * The decoded form of an entry of an allocation trace.
+ */
+struct AllocTraceEvent
+{
+    enum class Op: uint8_t
+    {
+        Alloc = 0,  //!< Allocation, the _size_ is the requested one, the _address_ is the result.
+        Free = 1,   //!< Release of the block at _address_, the _size_ is not used.
+        Resize = 2  //!< Resize of the block at _address_, the _size_ is the requested new one.
+    };
+
+    Op op;
+    uint32_t time;      //!< Ticks elapsed since the previous event.
+    uintptr_t address;  //!< Offset of the block from the base address plus one, zero for a failed allocation.
+    uintptr_t size;     //!< The requested size in bytes.
+};
+
+/**
+ * Compact binary encoding of allocation traces.
+ *
+ * Every event is stored as an operation byte followed by LEB128 style variable
+ * length integers (seven bits per byte, the MSB indicates continuation) for the
+ * time delta, the address offset and, except for releases, the size. This way
+ * a typical event takes just a few bytes.
+ */
+struct AllocTraceFormat
+{
+    /// The maximal number of bytes an encoded event can take.
+    static constexpr uint32_t maxEventSize = 1 + 5 + 2 * (sizeof(uintptr_t) * 8 + 6) / 7;
+
+    /**
+     * Encode an event.
+     *
+     * @param	out The buffer to write to, has to be at least _maxEventSize_ long.
+     * @return	The number of bytes written.
+     */
+    static inline uint32_t encode(const AllocTraceEvent &e, uint8_t* out)
+    {
+        uint8_t* p = out;
+        *p++ = static_cast<uint8_t>(e.op);
+        p = writeNumber(p, e.time);
+        p = writeNumber(p, e.address);
+
+        if(e.op != AllocTraceEvent::Op::Free)
+            p = writeNumber(p, e.size);
+
+        return p - out;
+    }
+
+    /**
+     * Decode an event.
+     *
+     * @param	in The start of the encoded data.
+     * @param	end The end of the available data.
+     * @return	The number of bytes consumed or zero if the data is incomplete or invalid.
+     */
+    static inline uint32_t decode(AllocTraceEvent &e, const uint8_t* in, const uint8_t* end)
+    {
+        const uint8_t* p = in;
+
+        if(p == end || *p > static_cast<uint8_t>(AllocTraceEvent::Op::Resize))
+            return 0;
+
+        e.op = static_cast<AllocTraceEvent::Op>(*p++);
+        uintptr_t time;
+
+        if(!(p = readNumber(p, end, time)) || !(p = readNumber(p, end, e.address)))
+            return 0;
+
+        e.time = time;
+        e.size = 0;
+
+        if(e.op != AllocTraceEvent::Op::Free && !(p = readNumber(p, end, e.size)))
+            return 0;
+
+        return p - in;
+    }
+
+private:
+    static inline uint8_t* writeNumber(uint8_t* p, uintptr_t v)
+    {
+        while(v >= 0x80)
+        {
+            *p++ = static_cast<uint8_t>(v | 0x80);
+            v >>= 7;
+        }
+
+        *p++ = static_cast<uint8_t>(v);
+        return p;
+    }
+
+    static inline const uint8_t* readNumber(const uint8_t* p, const uint8_t* end, uintptr_t &v)
+    {
+        v = 0;
+
+        for(unsigned int shift = 0; p != end && shift < sizeof(uintptr_t) * 8; shift += 7)
+        {
+            const uint8_t b = *p++;
+            v |= uintptr_t(b & 0x7f) << shift;
+
+            if(!(b & 0x80))
+                return p;
+        }
+
+        return nullptr;
+    }
+};
+
+/**
+ * Allocation trace recorder.
+ *
+ * Wraps a heap (or any allocator with the same interface) and records the
+ * allocation, release and resize operations done through it, along with the
+ * time elapsed between them in the compact binary format of AllocTraceFormat.
+ * The trace can then be replayed against any allocator (@see AllocReplay).
+ *
+ * The addresses are stored as offsets from a base address (the start of the
+ * heap space), so that they can be encoded in a few bytes.
+ *
+ * @tparam	Heap The type of the recorded heap, it needs to have the _alloc_, _free_
+ * 			and _resize_ methods with the same signature as the Heap class.
+ * @tparam	Clock Time source, it needs to have a static _now_ method that returns
+ * 			the current time in arbitrary units, as a 32 bit (wrapping) number.
+ * @tparam	Sink The receiver of the encoded data, it needs to have a
+ * 			_write(const uint8_t* data, uint32_t length)_ method.
+ *
+ * @note	Like the Heap, this is not guarded against concurrent access.
+ */
+template<class Heap, class Clock, class Sink>
+class AllocTraceRecorder
+{
+    Heap &heap;
+    Sink &sink;
+    const char* const base;
+    uint32_t last;
+
+    inline void record(AllocTraceEvent::Op op, const void* ptr, uintptr_t size)
+    {
+        const uint32_t now = Clock::now();
+        const AllocTraceEvent e
+        {
+            op,
+            now - last,
+            ptr ? uintptr_t(static_cast<const char*>(ptr) - base) + 1 : 0,
+            size
+        };
+
+        last = now;
+
+        uint8_t buffer[AllocTraceFormat::maxEventSize];
+        sink.write(buffer, AllocTraceFormat::encode(e, buffer));
+    }
+
+public:
+    /**
+     * Create a recorder.
+     *
+     * @param	heap The heap to be used for the actual operations.
+     * @param	sink The receiver of the trace data.
+     * @param	base The base address, it should be not be higher than any block.
+     */
+    inline AllocTraceRecorder(Heap &heap, Sink &sink, const void* base):
+        heap(heap), sink(sink), base(static_cast<const char*>(base)), last(Clock::now()) {}
+
+    /** @copydoc Heap::alloc */
+    inline void* alloc(uintptr_t size, bool hot = false)
+    {
+        void* ret = heap.alloc(size, hot);
+        record(AllocTraceEvent::Op::Alloc, ret, size);
+        return ret;
+    }
+
+    /** @copydoc Heap::free */
+    inline void free(void* ptr)
+    {
+        record(AllocTraceEvent::Op::Free, ptr, 0);
+        heap.free(ptr);
+    }
+
+    /** @copydoc Heap::resize */
+    inline uintptr_t resize(void* ptr, uintptr_t size)
+    {
+        record(AllocTraceEvent::Op::Resize, ptr, size);
+        return heap.resize(ptr, size);
+    }
+};
+
+/**
+ * Sequential reader of an encoded allocation trace.
+ */
+class AllocTraceReader
+{
+    const uint8_t* current;
+    const uint8_t* const end;
+
+public:
+    /**
+     * Create a reader for the trace data in the specified memory area.
+     */
+    inline AllocTraceReader(const void* data, uintptr_t length):
+        current(static_cast<const uint8_t*>(data)), end(current + length) {}
+
+    /**
+     * Decode the next event.
+     *
+     * @return	False if there are no more (complete) events.
+     */
+    inline bool read(AllocTraceEvent &e)
+    {
+        if(const auto n = AllocTraceFormat::decode(e, current, end))
+        {
+            current += n;
+            return true;
+        }
+
+        return false;
+    }
+};
+
+}
+
+#endif /* PET_HEAP_ALLOCTRACE_H_ */
@@ -32,15 +32,56 @@ namespace pet {
  * This is a dynamic memory management policy for Heap host class. Together they
  * form a non-realtime heap, capable of allocating and reclaiming a full or partial
  * block with logarithmic time complexity by the number of free blocks.
+ *
+ * If _addressOrdered_ is set, the free blocks are ordered by their address among the ones
+ * with the same size, and the one with the lowest address is chosen from the best fitting
+ * ones (address-ordered best-fit). This keeps the used blocks packed towards the start of
+ * the heap space, which tends to result in less fragmentation for long running workloads.
+ * Otherwise it is unspecified which one of the equally sized blocks is chosen (it is the
+ * one that the search of the tree reaches first).
  */
 
-template <class SizeType>
+template <class SizeType, bool addressOrdered = false>
 class AvlTreePolicy: protected HeapBase<SizeType>, protected pet::AvlTree
 {
     using typename HeapBase<SizeType>::Block;
 
-    static int sizeCompare(BinaryTree::Node* block, const unsigned int &size) {
-        return (int)(Block(block).getSize() - size);
+    /// Search key of the address-ordered mode.
+    struct Key
+    {
+        uintptr_t size, address;
+    };
+
+    static int sizeCompare(BinaryTree::Node* block, const uintptr_t &size)
+    {
+        const uintptr_t blockSize = Block(block).getSize();
+        return (blockSize > size) - (blockSize < size);
+    }
+
+    static int keyCompare(BinaryTree::Node* block, const Key &key)
+    {
+        const uintptr_t blockSize = Block(block).getSize();
+
+        if(blockSize != key.size)
+        {
+            return (blockSize > key.size) - (blockSize < key.size);
+        }
+
+        const uintptr_t address = reinterpret_cast<uintptr_t>(block);
+        return (address > key.address) - (address < key.address);
+    }
+
+    /// Find the position of the given size (and address in the address-ordered mode).
+    really_inline BinaryTree::Position seekBlock(uintptr_t size, uintptr_t address)
+    {
+        if constexpr(addressOrdered)
+        {
+            return BinaryTree::seek<Key, &AvlTreePolicy::keyCompare>(Key{size, address});
+        }
+        else
+        {
+            return BinaryTree::seek<uintptr_t, &AvlTreePolicy::sizeCompare>(size);
+        }
     }
 
 protected:
@@ -54,14 +95,32 @@ protected:
         add(block);
     }
 
+    /** @copydoc pet::TlsfPolicy::reset */
+    inline void reset() {
+        root = nullptr;
+    }
+
     /** @copydoc pet::TlsfPolicy::add */
     inline void add(Block block)
     {
-        BinaryTree::Position pos = BinaryTree::seek<unsigned int, &AvlTreePolicy::sizeCompare>(block.getSize());
-
-        while(pos.getNode()) {
+        BinaryTree::Position pos = seekBlock(block.getSize(), reinterpret_cast<uintptr_t>(block.ptr));
+
+        /*
+         * If there is a block with the same size, insert right before it
+         * in the ordering, that is at the largest position of its small
+         * subtree (otherwise it would end up before smaller blocks).
+         *
+         * In the address-ordered mode the keys are unique, so there is never
+         * a block with the same key already.
+         */
+        if(pos.getNode()) {
             pos.parent = pos.getNode();
             pos.origin = &pos.getNode()->small;
+
+            while(pos.getNode()) {
+                pos.parent = pos.getNode();
+                pos.origin = &pos.getNode()->big;
+            }
         }
 
         insert(pos, new(block.ptr) AvlTree::Node);
@@ -74,9 +133,14 @@ protected:
     }
 
     /** @copydoc pet::TlsfPolicy::findAndRemove */
-    inline Block findAndRemove(unsigned int size, bool hot)
+    inline Block findAndRemove(uintptr_t size, bool hot)
     {
-        BinaryTree::Position pos = BinaryTree::seek<unsigned int, &AvlTreePolicy::sizeCompare>(size);
+        /*
+         * In the address-ordered mode the search key is below every block of the
+         * requested size, so the first block not smaller than the key is found by
+         * the walk below, which is the one with the lowest address.
+         */
+        BinaryTree::Position pos = seekBlock(size, 0);
 
         if(Node *node = (Node*)pos.getNode())
         {
@@ -97,12 +161,26 @@ protected:
     }
 
     /** @copydoc pet::TlsfPolicy::update */
-    inline void update(unsigned int oldSize, Block block)
+    inline void update(uintptr_t oldSize, Block block)
     {
         remove(block);
         add(block);
     }
 
+    /** @copydoc pet::TlsfPolicy::longestSize */
+    inline uintptr_t longestSize()
+    {
+        BinaryTree::Node* node = root;
+
+        if(!node)
+            return 0;
+
+        while(node->big)
+            node = node->big;
+
+        return Block(node).getSize();
+    }
+
 };
 
 /**
@@ -110,8 +188,8 @@ protected:
  *
  * Facade to provide nicer usage, with automatically matching redundant parameters.
  */
-template<class SizeType, unsigned int alignmentBits, bool cheksummingOn = false>
-using AvlHeap = Heap<AvlTreePolicy<SizeType>, SizeType, alignmentBits, cheksummingOn>;
+template<class SizeType, unsigned int alignmentBits, bool cheksummingOn = false, bool statsOn = false, bool addressOrdered = false>
+using AvlHeap = Heap<AvlTreePolicy<SizeType, addressOrdered>, SizeType, alignmentBits, cheksummingOn, statsOn>;
 
 }
 
@@ -22,6 +22,7 @@
 
 #include "data/LinkedList.h"
 #include "heap/HeapBase.h"
+#include "managed/OffsetPtr.h"
 
 namespace pet {
 
@@ -31,67 +32,136 @@ namespace pet {
  * This is a dynamic memory management policy for Heap host class. Together they
  * form a non-realtime heap, capable of allocating and reclaiming a full or partial
  * block with linear time complexity by the number of free blocks.
+ *
+ * If _relativeLinks_ is set, the free blocks are linked through self-relative pointers
+ * (OffsetPtr), so the whole heap (including the heap object) is position independent, it
+ * can be placed in memory that is mapped at different addresses (@see Heap::rebase).
  */
 
-template <class SizeType>
+namespace detail
+{
+    template<class T, bool relative> struct BestFitLink { using Type = T*; };
+    template<class T> struct BestFitLink<T, true> { using Type = OffsetPtr<T>; };
+}
+
+template <class SizeType, bool relativeLinks = false>
 class BestFitPolicy: protected HeapBase<SizeType>
 {
     using typename HeapBase<SizeType>::Block;
 
     struct FreeBlock
     {
-        FreeBlock* next;
+        typename detail::BestFitLink<FreeBlock, relativeLinks>::Type next;
     };
 
     pet::LinkedList<FreeBlock> freeStore;
 
+    /// Size of the longest free block, for the statistics.
+    typename HeapBase<SizeType>::LongestFree longest;
+
 protected:
     static constexpr auto freeHeaderSize = sizeof(FreeBlock);
+    static constexpr bool isPositionIndependent = relativeLinks;
 
     really_inline void init(Block block)
     {
-        freeStore.clear();
+        reset();
         add(block);
     }
 
-    really_inline void add(Block block) {
+    really_inline void reset()
+    {
+        freeStore.clear();
+        longest.set(0);
+    }
+
+    really_inline void add(Block block)
+    {
         freeStore.add((FreeBlock *)block.ptr);
+        longest.added(block.getSize());
     }
 
-    really_inline void remove(Block block) {
+    really_inline void remove(Block block)
+    {
         freeStore.remove((FreeBlock *)block.ptr);
+        longest.removed(block.getSize());
     }
 
-    really_inline void update(unsigned int oldSize, Block block) {}
+    really_inline void update(uintptr_t oldSize, Block block) {
+        longest.changed(oldSize, block.getSize());
+    }
 
-    really_inline Block findAndRemove(unsigned int size, bool hot)
+    really_inline Block findAndRemove(uintptr_t size, bool hot)
     {
         typename decltype(freeStore)::Iterator best = freeStore.end();
-        unsigned int bestSize = -1u;
+        uintptr_t bestSize = uintptr_t(-1);
+
+        /*
+         * The longest of the blocks other than the best one, the whole list is looked through
+         * anyway (unless there is an exact match), so the cached longest size is refreshed too.
+         */
+        uintptr_t othersLongest = 0;
 
         for(auto it = freeStore.iterator(); it.current(); it.step())
         {
-            unsigned int currSize = Block(it.current()).getSize();
+            const uintptr_t currSize = Block(it.current()).getSize();
 
-            if(currSize == size)
+            if(currSize == size && currSize != longest.get())
             {
-                return it.remove();
+                longest.removed(currSize);
+                return Block(it.remove());
             }
-            else if (currSize > size && currSize < bestSize)
+            else if (currSize >= size && currSize < bestSize)
             {
+                if(best != freeStore.end() && othersLongest < bestSize)
+                    othersLongest = bestSize;
+
                 bestSize = currSize;
                 best = it;
             }
+            else if(othersLongest < currSize)
+            {
+                othersLongest = currSize;
+            }
         }
 
+        longest.set(othersLongest);
+
         if(best != freeStore.end())
         {
-            return best.remove();
+            return Block(best.remove());
         }
 
         return {nullptr};
     }
 
+    /**
+     * Longest free block.
+     *
+     * Returns the cached size in constant time, the list is only looked through if the cached
+     * block has been taken out (other than by an allocation) since the last query, without a
+     * larger one added since.
+     */
+    really_inline uintptr_t longestSize()
+    {
+        if(!longest.isKnown())
+        {
+            uintptr_t ret = 0;
+
+            for(auto it = freeStore.iterator(); it.current(); it.step())
+            {
+                const uintptr_t currSize = Block(it.current()).getSize();
+
+                if(ret < currSize)
+                    ret = currSize;
+            }
+
+            longest.set(ret);
+        }
+
+        return longest.get();
+    }
+
 };
 
 /**
@@ -99,8 +169,8 @@ protected:
  *
  * Facade to provide nicer usage, with automatically matching redundant parameters.
  */
-template<class SizeType, unsigned int alignmentBits, bool cheksummingOn = false>
-using BestFitHeap = Heap<BestFitPolicy<SizeType>, SizeType, alignmentBits, cheksummingOn>;
+template<class SizeType, unsigned int alignmentBits, bool cheksummingOn = false, bool statsOn = false, bool relativeLinks = false>
+using BestFitHeap = Heap<BestFitPolicy<SizeType, relativeLinks>, SizeType, alignmentBits, cheksummingOn, statsOn>;
 
 }
 
@@ -86,9 +86,28 @@ namespace pet {
  *   ^   ^   ^   ^       ^   ^   ^   ^       ^   ^   ^   ^        ^   ^   ^   ^
  */
 
-template<uint32_t minBlockSizeLog, uint32_t maxAlignBits>
-class BuddyAllocator
+/**
+ * Node tree of the buddy allocators.
+ *
+ * Contains the mapping between the memory area, the node indices and the packed
+ * node states, that is common for the sequential and the concurrent allocators.
+ *
+ * @tparam	Word The type of the words that the node states are packed into,
+ * 			it is either _uint32_t_ or an atomic wrapper around it.
+ * @tparam	withSummary If true, a byte of search acceleration data is stored for
+ * 			each non-leaf node, after the node states.
+ * @tparam	lazy If true, the node states (and summary) are not cleared on initialization,
+ * 			but in chunks, when they are first accessed (or by _initStep_). A bitmap that
+ * 			tracks the cleared chunks is stored after the rest of the tree data.
+ */
+template<uint32_t minBlockSizeLog, uint32_t maxAlignBits, class Word, bool withSummary = false, bool lazy = false>
+class BuddyTree
 {
+public:
+    /// The alignment of the start of the managed area (and of the blocks that are at least as large as this).
+    static constexpr uintptr_t maxAlignment = uintptr_t(1) << maxAlignBits;
+
+protected:
     static constexpr auto minBlockSize = 1 << minBlockSizeLog;
     static constexpr auto nBitsPerCell = 2;
     static constexpr auto nCellsPerByte = 8 / nBitsPerCell;
@@ -96,14 +115,26 @@ class BuddyAllocator
     static constexpr auto nCellsPerWord = nBytesPerWord * nCellsPerByte;
     static constexpr auto cellMask = (1 << nBitsPerCell)  - 1;
 
+    static_assert(sizeof(Word) == nBytesPerWord);
+
+    /// The number of nodes that are cleared together in lazy mode.
+    static constexpr uint32_t nNodesPerChunk = 1024;
+    static constexpr uint32_t nWordsPerChunk = nNodesPerChunk / nCellsPerWord;
+
     char *start, *end;
     uint32_t maxLevel = 0;
-    uint32_t *tree;
+    Word *tree;
+    uint8_t *summary;
+
+    /// The bitmap of the cleared chunks, the number of node words and the next chunk to clear (lazy mode only).
+    uint32_t *initMap;
+    uint32_t nNodeWords, initCursor;
 
     enum class NodeState: uint32_t {
         Free = 0,
         Partial = 1,
-        Used = 2
+        Used = 2,
+        Busy = 3 //!< Transitional state, used only by the concurrent allocator.
     };
 
     static inline constexpr auto idx2wordIndex(uint32_t idx) {
@@ -114,17 +145,46 @@ class BuddyAllocator
         return (idx % nCellsPerWord) * nBitsPerCell;
     }
 
-    inline NodeState getState(uint32_t idx) const {
-        auto byteIdx = idx2wordIndex(idx);
-        auto bitShift = idx2bitShift(idx);
-        return static_cast<NodeState>((tree[byteIdx] >> bitShift) & cellMask);
+    static inline constexpr NodeState wordState(uint32_t word, uint32_t idx) {
+        return static_cast<NodeState>((word >> idx2bitShift(idx)) & cellMask);
     }
 
-    inline void setState(uint32_t idx, NodeState state) {
-        auto byteIdx = idx2wordIndex(idx);
-        auto bitShift = idx2bitShift(idx);
-        const auto cleared = tree[byteIdx] & ~(cellMask << bitShift);
-        tree[byteIdx] = cleared | ((uint32_t)state) << (bitShift);
+    /// Clear a chunk of the node states (and the summary) in lazy mode.
+    inline void initChunk(uint32_t chunk) const
+    {
+        const auto firstWord = chunk * nWordsPerChunk;
+        const auto endWord = (firstWord + nWordsPerChunk < nNodeWords) ? firstWord + nWordsPerChunk : nNodeWords;
+
+        for(auto i = firstWord; i < endWord; i++)
+            this->tree[i] = 0;
+
+        if(withSummary)
+        {
+            const auto endNode = ((chunk + 1) * nNodesPerChunk < (1u << maxLevel)) ? (chunk + 1) * nNodesPerChunk : (1u << maxLevel);
+
+            for(auto i = chunk * nNodesPerChunk; i < endNode; i++)
+                this->summary[i] = 0;
+        }
+
+        initMap[chunk / 32] |= 1u << (chunk % 32);
+    }
+
+    /// Make sure that the chunk of the node is cleared, before accessing its state (or summary).
+    really_inline void ensure(uint32_t idx) const
+    {
+        if constexpr(lazy)
+        {
+            const auto chunk = idx / nNodesPerChunk;
+
+            if(unlikely(!((initMap[chunk / 32] >> (chunk % 32)) & 1)))
+                initChunk(chunk);
+        }
+    }
+
+    inline NodeState getState(uint32_t idx) const
+    {
+        ensure(idx);
+        return wordState(tree[idx2wordIndex(idx)], idx);
     }
 
     inline uint32_t ptr2idx(void* ptr) {
@@ -150,17 +210,13 @@ class BuddyAllocator
         return idx >> 1;
     }
 
-    inline void indicateUsed(uint32_t idx, uint32_t limit = 0)
-    {
-        setState(idx, NodeState::Used);
+    static inline auto sibling(uint32_t idx) {
+        return idx ^ 1;
+    }
 
-        if(idx != limit)
-        {
-            while((idx = parent(idx)) != limit)
-            {
-                setState(idx, NodeState::Partial);
-            }
-        }
+    /// The end of the range that is covered by the leaves of the tree.
+    inline char* coveredEnd() const {
+        return start + (minBlockSize << maxLevel);
     }
 
     inline auto checkParent(uint32_t idx)
@@ -175,42 +231,6 @@ class BuddyAllocator
         return idx;
     }
 
-    inline auto findActual(void* ptr)
-    {
-        if(start <= ptr && ptr < end)
-        {
-            auto idx = ptr2idx(ptr);
-
-            while(getState(idx) != NodeState::Used)
-                idx = parent(idx);
-
-            if(idx2ptr(idx) == ptr)
-                return idx;
-        }
-
-        return decltype(ptr2idx(nullptr))(0);
-    }
-
-    static inline auto sibling(uint32_t idx) {
-        return idx ^ 1;
-    }
-
-    inline uint32_t indicateUnused(uint32_t idx, uint32_t limit = 0)
-    {
-        do
-        {
-            setState(idx, NodeState::Free);
-
-            if(getState(sibling(idx)) != NodeState::Free)
-                return idx;
-
-            idx = parent(idx);
-        }
-        while(idx != limit);
-
-        return limit;
-    }
-
     template<class T>
     constexpr static inline T* align(T* ptr, uintptr_t nBytes) {
         return reinterpret_cast<T*>(reinterpret_cast<uintptr_t>(ptr) & ~(nBytes - 1));
@@ -254,20 +274,72 @@ class BuddyAllocator
         return true;
     }
 
-public:
-    static inline int minimalTreeSize(size_t size)
+    /// The size of the node states and the summary (the start of the bitmap of the cleared chunks in lazy mode).
+    static inline constexpr size_t stateBytes(uint32_t nNodeWords, uint32_t maxLevel) {
+        return (nNodeWords * nBytesPerWord + (withSummary ? (1 << maxLevel) : 0) + nBytesPerWord - 1) / nBytesPerWord * nBytesPerWord;
+    }
+
+    static inline constexpr size_t treeBytes(uint32_t nNodeWords, uint32_t maxLevel)
     {
-        const uint32_t sBits = 31 - clz(size);
+        const auto nChunks = (nNodeWords + nWordsPerChunk - 1) / nWordsPerChunk;
+        return lazy ? stateBytes(nNodeWords, maxLevel) + (nChunks + 31) / 32 * nBytesPerWord
+                    : nNodeWords * nBytesPerWord + (withSummary ? (1 << maxLevel) : 0);
+    }
 
-        if(sBits <= minBlockSizeLog)
-            return -1;
+    /// Both the node states and the summary is set up so that all nodes are free.
+    inline void clearTree(uint32_t nNodeWords)
+    {
+        if(withSummary)
+        {
+            this->summary = reinterpret_cast<uint8_t*>(this->tree + nNodeWords);
+        }
 
-        const auto maxLevel = sBits - minBlockSizeLog;
-        const auto nNodeCount = 1 << (maxLevel + 1);
-        return (nNodeCount + nCellsPerWord - 1) / nCellsPerWord * nBytesPerWord;
+        if constexpr(lazy)
+        {
+            this->nNodeWords = nNodeWords;
+            this->initCursor = 0;
+            this->initMap = reinterpret_cast<uint32_t*>(reinterpret_cast<char*>(this->tree) + stateBytes(nNodeWords, maxLevel));
+
+            const auto nChunks = (nNodeWords + nWordsPerChunk - 1) / nWordsPerChunk;
+
+            for(auto i = 0u; i < (nChunks + 31) / 32; i++)
+                this->initMap[i] = 0;
+
+            return;
+        }
+
+        for(auto i = 0u; i < nNodeWords; i++)
+            this->tree[i] = 0;
+
+        if(withSummary)
+        {
+            for(auto i = 0u; i < (1u << maxLevel); i++)
+                this->summary[i] = 0;
+        }
     }
 
-    inline bool init(void* start, void* end)
+    /**
+     * Clear some of the chunks that have not been accessed yet in lazy mode.
+     *
+     * @return	True if there is nothing left to clear.
+     */
+    inline bool clearStep(uint32_t budget)
+    {
+        const auto nChunks = (nNodeWords + nWordsPerChunk - 1) / nWordsPerChunk;
+
+        for(; initCursor < nChunks && budget; initCursor++)
+        {
+            if(!((initMap[initCursor / 32] >> (initCursor % 32)) & 1))
+            {
+                initChunk(initCursor);
+                budget--;
+            }
+        }
+
+        return initCursor == nChunks;
+    }
+
+    inline bool setup(void* start, void* end)
     {
         uint32_t nNodeWords;
 
@@ -275,37 +347,217 @@ public:
             return false;
 
         auto *e = reinterpret_cast<char*>(end);
-        this->tree = reinterpret_cast<decltype(tree)>(align(e - nNodeWords * nBytesPerWord, nBytesPerWord));
+        this->tree = reinterpret_cast<decltype(tree)>(align(e - treeBytes(nNodeWords, maxLevel), nBytesPerWord));
         this->end = reinterpret_cast<decltype(this->end)>(align(tree, minBlockSize));
 
-        for(int i = 0; i < nNodeWords; i++)
-            this->tree[i] = 0;
-
-        for(auto p = static_cast<char*>(this->end); p < end; p += minBlockSize)
-            indicateUsed(ptr2idx(p));
-
+        clearTree(nNodeWords);
         return true;
     }
 
-    inline bool init(void* start, void* end, void* treeStart, size_t treeSize)
+    inline bool setup(void* start, void* end, void* treeStart, size_t treeSize)
     {
         uint32_t nNodeWords;
 
         if(!initStartAndMaxLevel(start, end, nNodeWords))
             return false;
 
-        if(treeSize < nNodeWords * nBytesPerWord)
+        if(treeSize < treeBytes(nNodeWords, maxLevel))
             return false;
 
         this->tree = reinterpret_cast<decltype(tree)>(treeStart);
         this->end = reinterpret_cast<decltype(this->end)>(align(end, minBlockSize));
 
-        for(auto i = 0u; i < nNodeWords; i++)
-            this->tree[i] = 0;
+        clearTree(nNodeWords);
+        return true;
+    }
+
+public:
+    static inline int minimalTreeSize(size_t size)
+    {
+        const uint32_t sBits = 31 - clz(size);
+
+        if(sBits <= minBlockSizeLog)
+            return -1;
+
+        const auto maxLevel = sBits - minBlockSizeLog;
+        const auto nNodeCount = 1 << (maxLevel + 1);
+        const auto nNodeWords = (nNodeCount + nCellsPerWord - 1) / nCellsPerWord;
+        return (treeBytes(nNodeWords, maxLevel) + nBytesPerWord - 1) / nBytesPerWord * nBytesPerWord;
+    }
+};
+
+/**
+ * Buddy allocator.
+ *
+ * Manages power-of-two sized blocks in a continuous area, with the tracking data
+ * stored outside of the area, which makes it possible to manage memory that can not
+ * be written by the CPU or has special caching characteristics.
+ *
+ * Besides the node states the allocator keeps a summary byte for every non-leaf node,
+ * that tells the level of the largest block that can be allocated from the subtree of
+ * that node. It is stored as the difference from the level of the node, so that a zero
+ * filled summary means a completely free tree. These are updated along the path of the
+ * modified nodes, and are used for finding the first free node on allocation with a
+ * single descent from the root, that is in logarithmic time by the number of blocks.
+ *
+ * For large areas clearing the whole tree on initialization (and faulting in all of its
+ * pages) can take considerable time. If _lazyInit_ is set, the initialization only clears
+ * a small bitmap, and the tree is cleared in chunks when they are first accessed, so the
+ * allocator is ready right away. The rest can be cleared in the background via _initStep_.
+ */
+template<uint32_t minBlockSizeLog, uint32_t maxAlignBits, bool lazyInit = false>
+class BuddyAllocator: public BuddyTree<minBlockSizeLog, maxAlignBits, uint32_t, true, lazyInit>
+{
+    using Tree = BuddyTree<minBlockSizeLog, maxAlignBits, uint32_t, true, lazyInit>;
+    using typename Tree::NodeState;
+    using Tree::minBlockSize;
+    using Tree::cellMask;
+    using Tree::start;
+    using Tree::end;
+    using Tree::maxLevel;
+    using Tree::tree;
+    using Tree::summary;
+    using Tree::idx2wordIndex;
+    using Tree::idx2bitShift;
+    using Tree::getState;
+    using Tree::ptr2idx;
+    using Tree::level;
+    using Tree::idx2ptr;
+    using Tree::parent;
+    using Tree::sibling;
+    using Tree::size2level;
+
+    /// Summary value for a subtree that has no free node (neither the summary nor the level can be this high).
+    static constexpr uint8_t none = 0xff;
+
+    /// The level of the largest block that can be allocated in the subtree of the node, or _none_.
+    inline uint32_t availableLevel(uint32_t idx) const
+    {
+        if(idx >> maxLevel)
+        {
+            return (getState(idx) == NodeState::Free) ? maxLevel : none;
+        }
+
+        this->ensure(idx);
+        return (summary[idx] == none) ? none : level(idx) + summary[idx];
+    }
+
+    /// Recalculate the summary of the node and its parents after a change along the path.
+    inline void updateSummary(uint32_t idx)
+    {
+        if(idx >> maxLevel)
+        {
+            idx = parent(idx);
+        }
+
+        for(; idx; idx = parent(idx))
+        {
+            switch(getState(idx))
+            {
+            case NodeState::Free:
+                summary[idx] = 0;
+                break;
+            case NodeState::Partial:
+            {
+                const auto l = availableLevel(idx << 1);
+                const auto r = availableLevel(sibling(idx << 1));
+                const auto best = (l < r) ? l : r;
+                summary[idx] = (best == none) ? none : best - level(idx);
+                break;
+            }
+            default:
+                summary[idx] = none;
+            }
+        }
+    }
+
+    inline void setState(uint32_t idx, NodeState state) {
+        this->ensure(idx);
+        auto byteIdx = idx2wordIndex(idx);
+        auto bitShift = idx2bitShift(idx);
+        const auto cleared = tree[byteIdx] & ~(cellMask << bitShift);
+        tree[byteIdx] = cleared | ((uint32_t)state) << (bitShift);
+    }
+
+    inline void indicateUsed(uint32_t idx, uint32_t limit = 0)
+    {
+        setState(idx, NodeState::Used);
+
+        if(idx != limit)
+        {
+            while((idx = parent(idx)) != limit)
+            {
+                setState(idx, NodeState::Partial);
+            }
+        }
+    }
+
+    inline auto findActual(void* ptr)
+    {
+        if(start <= ptr && ptr < end)
+        {
+            auto idx = ptr2idx(ptr);
+
+            while(getState(idx) != NodeState::Used)
+                idx = parent(idx);
+
+            if(idx2ptr(idx) == ptr)
+                return idx;
+        }
+
+        return decltype(ptr2idx(nullptr))(0);
+    }
+
+    inline uint32_t indicateUnused(uint32_t idx, uint32_t limit = 0)
+    {
+        do
+        {
+            setState(idx, NodeState::Free);
+
+            if(getState(sibling(idx)) != NodeState::Free)
+                return idx;
+
+            idx = parent(idx);
+        }
+        while(idx != limit);
+
+        return limit;
+    }
+
+public:
+    inline bool init(void* start, void* end)
+    {
+        if(!this->setup(start, end))
+            return false;
+
+        for(auto p = static_cast<char*>(this->end); p < end && p < this->coveredEnd(); p += minBlockSize)
+        {
+            indicateUsed(ptr2idx(p));
+            updateSummary(ptr2idx(p));
+        }
 
         return true;
     }
 
+    inline bool init(void* start, void* end, void* treeStart, size_t treeSize) {
+        return this->setup(start, end, treeStart, treeSize);
+    }
+
+    /**
+     * Clear a part of the tree in the background (lazy mode only).
+     *
+     * Can be called from time to time (under the same locking as the other operations)
+     * to finish the initialization, so that the allocations do not need to do it later.
+     *
+     * @param	budget The maximal number of chunks (of 1024 nodes) to be cleared.
+     * @return	True if the whole tree has been cleared.
+     */
+    inline bool initStep(uint32_t budget)
+    {
+        static_assert(lazyInit, "BuddyAllocator::initStep is only available in lazy mode");
+        return this->clearStep(budget);
+    }
+
     inline void* allocate(uint32_t requested, uint32_t &actual)
     {
         if(requested)
@@ -316,24 +568,29 @@ public:
             if(!size2level(actual, searchLevel))
                 return nullptr;
 
-            auto searchStart = baseIdx(searchLevel);
-            auto searchEnd = searchStart << 1;
+            if(searchLevel < availableLevel(1))
+                return nullptr;
+
+            uint32_t idx = 1;
 
-            for(int i = searchStart; i < searchEnd; i++)
+            // Go for the leftmost subtree that has a large enough free node.
+            for(auto l = 0u; l < searchLevel; l++)
             {
-                if(getState(i) == NodeState::Free)
+                if(getState(idx) == NodeState::Free)
                 {
-                    if(auto failedAt = checkParent(i))
-                    {
-                        i = ((failedAt + 1) << (searchLevel - level(failedAt))) - 1;
-                    }
-                    else
-                    {
-                        indicateUsed(i);
-                        return idx2ptr(i);
-                    }
+                    idx <<= searchLevel - l;
+                    break;
                 }
+
+                idx <<= 1;
+
+                if(searchLevel < availableLevel(idx))
+                    idx = sibling(idx);
             }
+
+            indicateUsed(idx);
+            updateSummary(idx);
+            return idx2ptr(idx);
         }
 
         return nullptr;
@@ -350,6 +607,7 @@ public:
         if(auto idx = findActual(ptr))
         {
             indicateUnused(idx);
+            updateSummary(idx);
             return true;
         }
         else
@@ -377,11 +635,13 @@ public:
                     if(indicateUnused(idx, newIdx) == newIdx)
                     {
                         setState(newIdx, NodeState::Used);
+                        updateSummary(idx);
                         return true;
                     }
                     else
                     {
                         indicateUsed(idx, newIdx >> 1);
+                        updateSummary(idx);
                         return false;
                     }
                 }
@@ -391,6 +651,7 @@ public:
 
                     auto newIdx = ptr2idx(ptr) >> (maxLevel - newLevel);
                     indicateUsed(newIdx, idx >> 1);
+                    updateSummary(newIdx);
                     return true;
                 }
                 else
@@ -0,0 +1,292 @@
+/*******************************************************************************
+ *
+ * Copyright (c) 2026 Tamás Seller. All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *******************************************************************************/
+
+#ifndef PET_HEAP_CONCURRENTBUDDY_H_
+#define PET_HEAP_CONCURRENTBUDDY_H_
+
+#include "heap/Buddy.h"
+#include "heap/HeapBase.h"
+
+#include "platform/Atomic.h"
+
+namespace pet {
+
+/*
+ * Lock-free variant of the BuddyAllocator.
+ *
+ * The tree is the same as that of the sequential one, but all state changes are done by
+ * compare-and-swap operations on the words containing the cells. The climbs are done in
+ * a way that keeps the tree consistent, no matter how the operations of the different
+ * contexts are interleaved:
+ *
+ *  Allocate node:
+ *
+ *   1. Find a node at the requested level that is seen free.
+ *   2. Change its state from free to used atomically, if it fails the node is taken
+ *      by someone else, so go on with the search.
+ *   3. Go up until the root, and for each parent:
+ *      - if free or busy, change it to partially used (retry if changed meanwhile),
+ *      - if partially used, leave it as it is,
+ *      - if used, the node is part of a block that has been taken as a whole by someone
+ *        else, in this case release the node (as if it was freed) and go on searching.
+ *
+ *  Free node:
+ *
+ *   1. Find the topmost used node on the path from the root to the leaf of the address.
+ *   2. Mark it as free atomically, while observing the state of the sibling (the two
+ *      siblings are always in the same word).
+ *   3. If the sibling is not free -> exit, otherwise:
+ *      - try to mark the parent as busy if it is partially used, if it is not -> exit,
+ *      - check both of the children again, if either of them is not free anymore, then
+ *        set back the parent to partially used and exit,
+ *      - try to change the parent from busy to free, if it fails the parent has been taken
+ *        back by an allocation -> exit, otherwise move one up and restart from 3.
+ *
+ * The busy state signals that the node is about to be freed, but it is not free yet. An
+ * allocation that climbs through a busy node does not need to wait for the release to
+ * complete, it turns it back to partially used, which makes the release give up at
+ * that point.
+ *
+ * The topmost used node of the path needs to be found on release (unlike the sequential
+ * version that searches upwards from the leaf), because there can be transiently used
+ * nodes inside a used block, that belong to an allocation that is about to fail.
+ */
+
+/**
+ * Lock-free buddy allocator.
+ *
+ * The same as the BuddyAllocator, except that _allocate_ and _free_ can be called
+ * concurrently from any number of threads or interrupt handlers without locking.
+ * The in-place resize (_adjust_) operation is not provided, and the search for a free
+ * node always traverses the whole requested level, as all auxiliary data would need
+ * to be updated atomically along with the node states.
+ *
+ * @note	The initialization is not thread-safe, it has to be completed before the
+ * 			first concurrent allocation.
+ */
+template<uint32_t minBlockSizeLog, uint32_t maxAlignBits>
+class ConcurrentBuddyAllocator: public BuddyTree<minBlockSizeLog, maxAlignBits, pet::Atomic<uint32_t>>
+{
+    using Tree = BuddyTree<minBlockSizeLog, maxAlignBits, pet::Atomic<uint32_t>>;
+    using typename Tree::NodeState;
+    using Tree::minBlockSize;
+    using Tree::cellMask;
+    using Tree::start;
+    using Tree::end;
+    using Tree::maxLevel;
+    using Tree::tree;
+    using Tree::idx2wordIndex;
+    using Tree::idx2bitShift;
+    using Tree::wordState;
+    using Tree::getState;
+    using Tree::ptr2idx;
+    using Tree::baseIdx;
+    using Tree::level;
+    using Tree::idx2ptr;
+    using Tree::parent;
+    using Tree::sibling;
+    using Tree::checkParent;
+    using Tree::size2level;
+
+    /**
+     * Atomically change the state of a node if it is the expected one.
+     *
+     * @param	old Receives the contents of the word before the operation.
+     * @return	True if the state of the node was the expected one and it got changed.
+     */
+    inline bool transition(uint32_t idx, NodeState expected, NodeState desired, uint32_t &old)
+    {
+        const auto shift = idx2bitShift(idx);
+
+        old = tree[idx2wordIndex(idx)]([shift](uint32_t o, uint32_t &n, NodeState e, NodeState d)
+        {
+            if(static_cast<NodeState>((o >> shift) & cellMask) != e)
+                return false;
+
+            n = (o & ~(cellMask << shift)) | (uint32_t)d << shift;
+            return true;
+        }, expected, desired);
+
+        return wordState(old, idx) == expected;
+    }
+
+    inline bool transition(uint32_t idx, NodeState expected, NodeState desired)
+    {
+        uint32_t _;
+        return transition(idx, expected, desired, _);
+    }
+
+    /**
+     * Mark the ancestors of a freshly taken node as partially used.
+     *
+     * @return	False if a used ancestor has been found.
+     */
+    inline bool indicateUsed(uint32_t idx)
+    {
+        while((idx = parent(idx)) != 0)
+        {
+            while(true)
+            {
+                const auto state = getState(idx);
+
+                if(state == NodeState::Used)
+                    return false;
+
+                if(state == NodeState::Partial || transition(idx, state, NodeState::Partial))
+                    break;
+            }
+        }
+
+        return true;
+    }
+
+    /**
+     * Release a node and merge it with its buddies as far as possible.
+     */
+    inline void indicateUnused(uint32_t idx)
+    {
+        uint32_t word;
+        bool ok = transition(idx, NodeState::Used, NodeState::Free, word);
+        Trace<AllHeapsTrace>::assertThat(ok, "Buddy corruption: releasing a node that is not used");
+
+        while(wordState(word, sibling(idx)) == NodeState::Free)
+        {
+            const auto p = parent(idx);
+
+            if(!p || !transition(p, NodeState::Partial, NodeState::Busy))
+                return;
+
+            const uint32_t children = tree[idx2wordIndex(idx)];
+
+            if(wordState(children, idx) != NodeState::Free || wordState(children, sibling(idx)) != NodeState::Free)
+            {
+                transition(p, NodeState::Busy, NodeState::Partial);
+                return;
+            }
+
+            if(!transition(p, NodeState::Busy, NodeState::Free, word))
+                return;
+
+            idx = p;
+        }
+    }
+
+    inline auto findActual(void* ptr)
+    {
+        if(start <= ptr && ptr < end)
+        {
+            const auto leaf = ptr2idx(ptr);
+
+            for(auto l = 0u; l <= maxLevel; l++)
+            {
+                const auto idx = leaf >> (maxLevel - l);
+
+                if(getState(idx) == NodeState::Used)
+                {
+                    if(idx2ptr(idx) == ptr)
+                        return idx;
+
+                    break;
+                }
+            }
+        }
+
+        return decltype(ptr2idx(nullptr))(0);
+    }
+
+public:
+    /** @copydoc BuddyAllocator::init(void*, void*) */
+    inline bool init(void* start, void* end)
+    {
+        if(!this->setup(start, end))
+            return false;
+
+        for(auto p = static_cast<char*>(this->end); p < end && p < this->coveredEnd(); p += minBlockSize)
+        {
+            const auto idx = ptr2idx(p);
+            transition(idx, NodeState::Free, NodeState::Used);
+            indicateUsed(idx);
+        }
+
+        return true;
+    }
+
+    /** @copydoc BuddyAllocator::init(void*, void*, void*, size_t) */
+    inline bool init(void* start, void* end, void* treeStart, size_t treeSize) {
+        return this->setup(start, end, treeStart, treeSize);
+    }
+
+    inline void* allocate(uint32_t requested, uint32_t &actual)
+    {
+        if(requested)
+        {
+            uint32_t searchLevel;
+
+            actual = requested;
+            if(!size2level(actual, searchLevel))
+                return nullptr;
+
+            auto searchStart = baseIdx(searchLevel);
+            auto searchEnd = searchStart << 1;
+
+            for(int i = searchStart; i < searchEnd; i++)
+            {
+                if(getState(i) == NodeState::Free)
+                {
+                    if(auto failedAt = checkParent(i))
+                    {
+                        i = ((failedAt + 1) << (searchLevel - level(failedAt))) - 1;
+                    }
+                    else if(transition(i, NodeState::Free, NodeState::Used))
+                    {
+                        if(indicateUsed(i))
+                            return idx2ptr(i);
+
+                        indicateUnused(i);
+                    }
+                }
+            }
+        }
+
+        return nullptr;
+    }
+
+    inline void* allocate(uint32_t requested)
+    {
+        uint32_t _;
+        return allocate(requested, _);
+    }
+
+    inline bool free(void* ptr)
+    {
+        if(auto idx = findActual(ptr))
+        {
+            indicateUnused(idx);
+            return true;
+        }
+        else
+        {
+            return false;
+        }
+    }
+};
+
+}
+
+#endif /* PET_HEAP_CONCURRENTBUDDY_H_ */
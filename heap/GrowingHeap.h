@@ -0,0 +1,334 @@
+/*******************************************************************************
+ *
+ * Copyright (c) 2026 Tamás Seller. All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *******************************************************************************/
+
+#ifndef PET_HEAP_GROWINGHEAP_H_
+#define PET_HEAP_GROWINGHEAP_H_
+
+#include "heap/Heap.h"
+
+#include "platform/Compiler.h"
+
+#include <stdint.h>
+
+namespace pet {
+
+/**
+ * Heap that grows on demand.
+ *
+ * Instead of managing a single area that has to be large enough for the peak usage,
+ * this heap obtains chunks of memory from a provider (like the MmapProvider) when it
+ * runs out of space, and adds them to the underlying heap as separate regions (@see
+ * Heap::addRegion). The free blocks of all regions are kept in the same free store.
+ *
+ * When a block is released and that leaves a whole additional chunk unused, the chunk
+ * is removed from the heap and given back to the provider right away, so the memory
+ * footprint follows the actual load. The first chunk is used to initialize the heap,
+ * it is kept until the object is destroyed.
+ *
+ * The pages inside large free blocks can also be given back (without removing them from
+ * the heap) by the _trim_ method, or automatically on release if the _trimThreshold_ is set.
+ *
+ * @tparam	Heap The type of the underlying heap, it is used exclusively by this object.
+ * @tparam	Provider The source of the chunks, it has to have the static _acquire(uintptr_t size)_
+ * 			method, that returns the start of an area of the specified size (or NULL on failure),
+ * 			and the _release(void* ptr, uintptr_t size)_ method, that takes it back.
+ * @tparam	chunkSize The minimal size of a chunk, larger requests are rounded up to a multiple of it.
+ * @tparam	trimThreshold If not zero, the free blocks that are at least this large (in bytes) are trimmed
+ * 			when they are released (or merged with a released block). Requires the provider to have the
+ * 			static _pageSize()_ and _discard(void* ptr, uintptr_t size)_ methods.
+ *
+ * @note	Like the Heap, this is not guarded against concurrent access.
+ */
+template<class Heap, class Provider, uintptr_t chunkSize = 1024 * 1024, uintptr_t trimThreshold = 0>
+class GrowingHeap: pet::Trace<AllHeapsTrace>
+{
+    /**
+     * Header of the additional chunks, placed at their start.
+     */
+    struct Region
+    {
+        Region* next;
+        uintptr_t size;
+    };
+
+    /// The space needed in a chunk besides a block of the given size, with some slack for the alignment.
+    static constexpr uintptr_t overhead = sizeof(Region) + 8 * Heap::alignment + 64;
+
+    Heap heap;
+
+    /// The first chunk, that the heap is initialized with.
+    void* base = nullptr;
+    uintptr_t baseSize = 0;
+
+    /// The additional chunks.
+    Region* regions = nullptr;
+
+    /**
+     * The size of the chunk to be requested for a block of the given size.
+     *
+     * The segregated fit policies round the requested size up to the next size class
+     * when searching (by up to a half for the coarsest TLSF configuration), so there
+     * is some room left for that as well, otherwise the new chunk might not be used.
+     */
+    static really_inline uintptr_t chunkSizeFor(uintptr_t size)
+    {
+        const uintptr_t needed = size + size / 2 + overhead;
+        return (needed + chunkSize - 1) / chunkSize * chunkSize;
+    }
+
+    /**
+     * Obtain a new chunk that can hold a block of the requested size.
+     */
+    inline bool grow(uintptr_t size)
+    {
+        const uintptr_t total = chunkSizeFor(size);
+
+        if(total < size)
+        {
+            return false;
+        }
+
+        void* chunk = Provider::acquire(total);
+
+        if(!chunk)
+        {
+            warn() << "GrowingHeap: Can not acquire " << total << " bytes\n";
+            return false;
+        }
+
+        if(!base)
+        {
+            base = chunk;
+            baseSize = total;
+            heap.init(chunk, total);
+        }
+        else
+        {
+            Region* region = static_cast<Region*>(chunk);
+            region->size = total;
+            region->next = regions;
+            regions = region;
+            heap.addRegion(region + 1, total - sizeof(Region));
+        }
+
+        return true;
+    }
+
+    /**
+     * Give back the chunk if the released block spans a whole additional one.
+     */
+    inline bool shrink(void* freed)
+    {
+        if(regions && heap.removeRegion(freed))
+        {
+            for(Region** link = &regions; *link; link = &(*link)->next)
+            {
+                Region* region = *link;
+
+                if(Heap::firstBlock(region + 1) == freed)
+                {
+                    *link = region->next;
+                    Provider::release(region, region->size);
+                    return true;
+                }
+            }
+
+            assertThat(false, "GrowingHeap: Unknown region removed");
+        }
+
+        return false;
+    }
+
+public:
+    /// The alignment of the allocated blocks (@see Heap::alignment).
+    static constexpr uintptr_t alignment = Heap::alignment;
+
+    /**
+     * Create an empty heap, the first chunk is acquired on the first allocation.
+     */
+    inline GrowingHeap() = default;
+
+    GrowingHeap(const GrowingHeap&) = delete;
+
+    /**
+     * Give back all the chunks to the provider.
+     */
+    inline ~GrowingHeap()
+    {
+        while(Region* region = regions)
+        {
+            regions = region->next;
+            Provider::release(region, region->size);
+        }
+
+        if(base)
+        {
+            Provider::release(base, baseSize);
+        }
+    }
+
+    /**
+     * Allocate memory, acquiring a new chunk if needed.
+     *
+     * @param	size The amount (in bytes) to be allocated.
+     * @param	hot Prefer lower addresses if true higher if false
+     * @return	A pointer to the start of the allocated region or NULL on failure.
+     */
+    inline void* alloc(uintptr_t size, bool hot = false)
+    {
+        if(likely(base != nullptr))
+        {
+            if(void* ret = heap.alloc(size, hot))
+            {
+                return ret;
+            }
+        }
+
+        return grow(size) ? heap.alloc(size, hot) : nullptr;
+    }
+
+    /**
+     * Allocate memory with an alignment larger than that of the heap, acquiring a new chunk if needed.
+     *
+     * @see	Heap::allocAligned for the details.
+     */
+    inline void* allocAligned(uintptr_t size, uintptr_t align)
+    {
+        if(likely(base != nullptr))
+        {
+            if(void* ret = heap.allocAligned(size, align))
+            {
+                return ret;
+            }
+        }
+
+        return (size <= uintptr_t(-1) - align && grow(size + align)) ? heap.allocAligned(size, align) : nullptr;
+    }
+
+    /**
+     * Release memory, giving back the containing chunk if it became unused.
+     *
+     * @param	ptr The pointer to the block, as returned by _alloc_.
+     */
+    inline void free(void* ptr)
+    {
+        void* freed = heap.free(ptr);
+
+        if(!shrink(freed))
+        {
+            if constexpr(trimThreshold != 0)
+            {
+                heap.trimBlock(freed, Provider::pageSize(), Provider::discard, trimThreshold);
+            }
+        }
+    }
+
+    /**
+     * Give back the pages inside the free blocks of all chunks to the provider.
+     *
+     * @see	Heap::trim for the details.
+     * @return	The number of bytes discarded.
+     */
+    inline uintptr_t trim()
+    {
+        if(!base)
+        {
+            return 0;
+        }
+
+        uintptr_t ret = heap.trim(base, Provider::pageSize(), Provider::discard);
+
+        for(Region* region = regions; region; region = region->next)
+        {
+            ret += heap.trim(region + 1, Provider::pageSize(), Provider::discard);
+        }
+
+        return ret;
+    }
+
+    /**
+     * Resize an allocation in place.
+     *
+     * @see	Heap::resize for the details.
+     */
+    inline uintptr_t resize(void* ptr, uintptr_t size) {
+        return heap.resize(ptr, size);
+    }
+
+    /**
+     * Resize an allocation, moving the data (possibly to a new chunk) if needed.
+     *
+     * @see	Heap::reallocate for the details.
+     */
+    inline void* reallocate(void* ptr, uintptr_t size)
+    {
+        if(!ptr)
+        {
+            return alloc(size);
+        }
+
+        if(void* ret = heap.reallocate(ptr, size))
+        {
+            return ret;
+        }
+
+        return grow(size) ? heap.reallocate(ptr, size) : nullptr;
+    }
+
+    /**
+     * Get usable size of an allocation.
+     *
+     * @see	Heap::getSize for the details.
+     */
+    static inline uintptr_t getSize(void* ptr) {
+        return Heap::getSize(ptr);
+    }
+
+    /**
+     * Get usable size of an allocation of a given size.
+     *
+     * @see	Heap::usableSize for the details.
+     */
+    static constexpr uintptr_t usableSize(uintptr_t size) {
+        return Heap::usableSize(size);
+    }
+
+    /**
+     * Allocate memory for an object of type T.
+     */
+    template<class T>
+    inline void* allocFor()
+    {
+        static_assert(alignof(T) <= Heap::alignment, "Object requires larger alignment than that of the heap");
+        return alloc(sizeof(T));
+    }
+
+    /**
+     * Get the usage statistics of the underlying heap.
+     *
+     * @see	Heap::getStats for the details (requires statistics tracking to be enabled).
+     */
+    inline HeapStat getStats() {
+        return heap.getStats();
+    }
+};
+
+}
+
+#endif /* PET_HEAP_GROWINGHEAP_H_ */
@@ -23,6 +23,7 @@
 #include "heap/HeapBase.h"
 
 #include "algorithm/Math.h"
+#include "algorithm/MinMaxHeap.h"
 
 #include "platform/Compiler.h"
 #include "platform/Clz.h"
@@ -39,6 +40,39 @@ struct HeapStat
     size_t totalUsed;
 };
 
+/**
+ * Incrementally maintained heap statistics.
+ *
+ * The counters are updated by the Heap host on every operation if the tracking is
+ * enabled, otherwise this is an empty base.
+ */
+template<bool enabled>
+struct HeapCounters {};
+
+template<>
+struct HeapCounters<true>
+{
+    uintptr_t totalUnits = 0;   //!< The size of the whole heap space in internal units.
+    uintptr_t freeUnits = 0;    //!< The total size of free blocks in internal units.
+    uintptr_t nFree = 0;        //!< The number of free blocks.
+    uintptr_t nUsed = 0;        //!< The number of used blocks.
+};
+
+/**
+ * State of the incremental integrity verification.
+ *
+ * Only present if the checksumming is enabled, otherwise this is an empty base.
+ */
+template<bool enabled, class SizeType>
+struct HeapVerifierState {};
+
+template<class SizeType>
+struct HeapVerifierState<true, SizeType>
+{
+    SizeType* verifyFirst = nullptr;    //!< The first block of the heap.
+    SizeType* verifyCursor = nullptr;   //!< The next block to be verified.
+};
+
 /**
  * Policy based heap.
  *
@@ -121,11 +155,16 @@ struct HeapStat
  * 			and before every access to a block its checksum is validated. Reports
  * 			error through the Trace<AllHeapsTrace>. If false the checks are optimized
  * 			away.
+ * @tparam	trackStats If true the usage statistics are updated on every operation,
+ * 			so that they can be queried without walking all the blocks, via the
+ * 			getStats() method.
  */
 
-template<class Policy, class SizeType, unsigned int alignmentBits, bool useChecksum = false>
+template<class Policy, class SizeType, unsigned int alignmentBits, bool useChecksum = false, bool trackStats = false>
 class Heap:	public Policy,
-            protected pet::Trace<AllHeapsTrace>
+            protected pet::Trace<AllHeapsTrace>,
+            HeapCounters<trackStats>,
+            HeapVerifierState<useChecksum, SizeType>
 {
     static_assert(alignof(SizeType) <= (1 << alignmentBits));
     using Base = HeapBase<SizeType>;
@@ -305,9 +344,12 @@ class Heap:	public Policy,
             static constexpr auto sizeBits = 8 * sizeof(SizeType);
             static constexpr auto sizeLog = ilog2(sizeBits);
 
-            const auto f = (v + 5) * (k + 31);
+            // Unsigned type at least as wide as both SizeType and unsigned int (to avoid the integer promotion to int).
+            using Word = decltype(SizeType() + 0u);
+
+            const SizeType f = (Word(v) + 5u) * (Word(k) + 31u);
             const auto top = f >> (sizeBits - sizeLog);
-            const auto rot = (f >> top) | (f << (sizeBits - top));
+            const SizeType rot = (Word(f) >> top) | (Word(f) << ((sizeBits - top) % sizeBits));
 
             return getLow(rot) ^ getHigh(rot);
         }
@@ -376,7 +418,161 @@ class Heap:	public Policy,
         return minEncodedBlockSize + size <= block.getSize();
     }
 
+    /**
+     * Keep the verification cursor on a block boundary.
+     *
+     * Must be called after the specified block has been extended over the
+     * blocks following it, if the cursor pointed into the extended block, it
+     * is moved back to its start.
+     */
+    really_inline void keepCursor(Block block)
+    {
+        if constexpr(useChecksum)
+        {
+            if(block.ptr < this->verifyCursor && this->verifyCursor < block.getNext().ptr)
+            {
+                this->verifyCursor = block.ptr;
+            }
+        }
+    }
+
+    /**
+     * Move a used block to the start of the free block before it.
+     *
+     * The previous block (and also the next one if requested) is merged into
+     * the moved one, so the resulting used block is at least as large as the
+     * sum of these, the surplus is not split off here.
+     *
+     * @param	block The used block to be moved, the previous one must be free.
+     * @param	mergeNext If true the next block (that must be free) is also merged.
+     * @return	The block at the new location.
+     */
+    inline Block moveIntoPrev(Block block, bool mergeNext)
+    {
+        const auto prev(block.getPrev());
+        const uintptr_t payload = decode(block.getSize()) - Block::headerSize;
+
+        storeRemove(prev);
+
+        if(mergeNext)
+        {
+            const auto next(block.getNext());
+            storeRemove(next);
+            prev.merge(next);
+            keepCursor(prev);
+        }
+        else
+        {
+            prev.merge(block);
+            keepCursor(prev);
+        }
+
+        prev.updateNext(end);
+        prev.setFree(false);
+        prev.updateChecksum();
+
+        movePayload(prev.ptr, block.ptr, payload);
+        return prev;
+    }
+
+    /**
+     * Move payload data.
+     *
+     * The payload can hold objects of any type, so it is moved as raw bytes (the
+     * compiler provided memmove is used, that also handles overlapping ranges).
+     */
+    static inline void movePayload(void* dst, const void* src, uintptr_t size) {
+        __builtin_memmove(dst, src, size);
+    }
+
+    /// Ordering of the blocks by address, for sorting.
+    static inline bool addressLess(void* const &a, void* const &b) {
+        return (uintptr_t)a < (uintptr_t)b;
+    }
+
+    /**
+     * Release the pages inside the payload of a free block.
+     *
+     * The header of the block (including the part used by the policy) and the
+     * header of the next block are not touched.
+     *
+     * @return	The number of bytes released.
+     */
+    template<class Discard>
+    static inline uintptr_t discardPages(Block block, uintptr_t pageSize, Discard &&discard)
+    {
+        const uintptr_t from = ((uintptr_t)block.ptr + Policy::freeHeaderSize + pageSize - 1) & ~(pageSize - 1);
+        const uintptr_t to = ((uintptr_t)block.getNext().ptr - Block::headerSize) & ~(pageSize - 1);
+
+        if(from < to)
+        {
+            discard((void*)from, to - from);
+            return to - from;
+        }
+
+        return 0;
+    }
+
+    /**
+     * Free store access.
+     *
+     * All the policy operations are done through these, in order
+     * to keep the statistics up to date (if enabled).
+     */
+    really_inline void storeAdd(Block block)
+    {
+        if constexpr(trackStats)
+        {
+            this->freeUnits += block.getSize();
+            this->nFree++;
+        }
+
+        this->Policy::add(block);
+    }
+
+    really_inline void storeRemove(Block block)
+    {
+        if constexpr(trackStats)
+        {
+            this->freeUnits -= block.getSize();
+            this->nFree--;
+        }
+
+        this->Policy::remove(block);
+    }
+
+    really_inline void storeUpdate(uintptr_t oldSize, Block block)
+    {
+        if constexpr(trackStats)
+        {
+            this->freeUnits += block.getSize() - oldSize;
+        }
+
+        this->Policy::update(oldSize, block);
+    }
+
+    really_inline Block storeFindAndRemove(uintptr_t size, bool hot)
+    {
+        const Block ret(this->Policy::findAndRemove(size, hot));
+
+        if constexpr(trackStats)
+        {
+            if(ret.ptr)
+            {
+                this->freeUnits -= ret.getSize();
+                this->nFree--;
+            }
+        }
+
+        return ret;
+    }
+
 public:
+    /**
+     * The alignment of the allocated blocks in bytes.
+     */
+    static constexpr uintptr_t alignment = uintptr_t(1) << alignmentBits;
+
     /**
      * Create an uninitialized heap, must be set up before use with the **init** method.
      */
@@ -413,9 +609,209 @@ public:
 
         Policy::init(first);
 
+        if constexpr(useChecksum)
+        {
+            this->verifyFirst = this->verifyCursor = first.ptr;
+        }
+
+        if constexpr(trackStats)
+        {
+            this->totalUnits = this->freeUnits = first.getSize();
+            this->nFree = 1;
+            this->nUsed = 0;
+        }
+
         info() << "Heap created at: " << start << " - " << (void*)(((char*)start) + size) << "\n";
     }
 
+    /**
+     * Take over a heap space that has been initialized earlier.
+     *
+     * As the block headers store only sizes, the layout of the blocks remains valid if the heap
+     * space is moved to a different address (for example if it is stored in a file and mapped again
+     * later, possibly by another process). Only the free store, that consists of pointers, needs to
+     * be rebuilt, which is done by walking all the blocks. During the walk the consistency of the
+     * blocks is verified (including the checksums, if enabled), so that a heap space that has been
+     * left in an inconsistent state (for example, by a crash in the middle of an operation) is not
+     * taken over.
+     *
+     * @param	start The pointer to the start of the heap space.
+     * @param	size The size of the heap space, must be the same as on initialization.
+     * @return	True on success, false if the heap space is found to be invalid, in which case
+     * 			the heap must not be used (until initialized or attached successfully).
+     */
+    inline bool attach(void* start, uintptr_t size)
+    {
+        const auto firstBlockPtr = (char*)firstBlock(start);
+        const auto downAlignedSize = alignDown((uintptr_t)((char*)start + size - firstBlockPtr));
+
+        end.ptr = (SizeType*)(firstBlockPtr + downAlignedSize);
+
+        Policy::reset();
+
+        if constexpr(trackStats)
+        {
+            this->totalUnits = this->freeUnits = this->nFree = this->nUsed = 0;
+        }
+
+        Block block(firstBlockPtr);
+        bool prevFree = false;
+
+        if(block.hasPrev())
+        {
+            return false;
+        }
+
+        while(true)
+        {
+            if(!block.checkChecksum() || !block.getSize() || end.ptr < block.getNext().ptr)
+            {
+                return false;
+            }
+
+            if(block.isFree())
+            {
+                if(prevFree)
+                {
+                    return false;
+                }
+
+                storeAdd(block);
+            }
+            else if constexpr(trackStats)
+            {
+                this->nUsed++;
+            }
+
+            if constexpr(trackStats)
+            {
+                this->totalUnits += block.getSize();
+            }
+
+            if(!block.hasNext(end))
+            {
+                break;
+            }
+
+            const auto next(block.getNext());
+
+            if(next.getPrev().ptr != block.ptr)
+            {
+                return false;
+            }
+
+            prevFree = block.isFree();
+            block = next;
+        }
+
+        if constexpr(useChecksum)
+        {
+            this->verifyFirst = this->verifyCursor = (SizeType*)firstBlockPtr;
+        }
+
+        info() << "Heap attached at: " << start << " - " << (void*)(((char*)start) + size) << "\n";
+        return true;
+    }
+
+    /**
+     * Adjust the heap object to the current address of its heap space.
+     *
+     * Unlike _attach_ this does not rebuild the free store, it is meant for heaps whose heap
+     * object is moved along with the heap space (for example both of them are in shared memory,
+     * that is mapped at different addresses by the processes using it). This requires the links
+     * of the free store to be position independent (like the BestFitPolicy with relative links).
+     * It takes constant time, so it can be done before every operation.
+     *
+     * @param	start The pointer to the start of the heap space, as seen by the caller.
+     * @param	size The size of the heap space, must be the same as on initialization.
+     *
+     * @note	Additional regions (@see addRegion) can not be used with relocated heaps.
+     */
+    inline void rebase(void* start, uintptr_t size)
+    {
+        static_assert(Policy::isPositionIndependent, "Heap::rebase requires a position independent policy");
+
+        const auto firstBlockPtr = (char*)firstBlock(start);
+        end.ptr = (SizeType*)(firstBlockPtr + alignDown((uintptr_t)((char*)start + size - firstBlockPtr)));
+
+        if constexpr(useChecksum)
+        {
+            this->verifyFirst = this->verifyCursor = (SizeType*)firstBlockPtr;
+        }
+    }
+
+    /**
+     * Add an additional region of memory to an initialized heap.
+     *
+     * The blocks of the new region form a separate chain, that is terminated by a zero
+     * sized, permanently used sentinel block at the end of the region, so they are never
+     * merged with the blocks of other regions. The free blocks of all the regions are kept
+     * in the same free store, so any of them can be used to satisfy a request.
+     *
+     * @param	start The pointer to the start of the region.
+     * @param	size The size of the region.
+     *
+     * @see	removeRegion
+     */
+    inline void addRegion(void* start, uintptr_t size)
+    {
+        const auto firstBlockPtr = (char*)firstBlock(start);
+        const auto sentinelPtr = (char*)alignDown((uintptr_t)((char*)start + size));
+
+        assertThat(firstBlockPtr + decode(minEncodedBlockSize) + Block::headerSize <= sentinelPtr, "addRegion(): Region too small");
+        assertThat(uintptr_t(sentinelPtr - firstBlockPtr) <= maxBlockSize, "Heap too big for format (SizeType can not represent size of region)");
+
+        const Block first(firstBlockPtr);
+        const Block sentinel(sentinelPtr);
+
+        first.setFree(true);
+        first.setNext(sentinel);
+        first.setPrev(first);
+        first.updateChecksum();
+
+        sentinel.setFree(false);
+        sentinel.setSize(0);
+        sentinel.setPrev(first);
+        sentinel.updateChecksum();
+
+        if constexpr(trackStats)
+        {
+            this->totalUnits += first.getSize();
+        }
+
+        storeAdd(first);
+
+        info() << "Heap region added at: " << start << " - " << (void*)(((char*)start) + size) << "\n";
+    }
+
+    /**
+     * Take out a region that was added by _addRegion_, if it is completely unused.
+     *
+     * @param	ptr A free block, as returned by _free_.
+     * @return	True if the block spans a whole additional region, in which case it is removed
+     * 			from the heap and the memory of the region can be reused, false otherwise.
+     */
+    inline bool removeRegion(void* ptr)
+    {
+        const Block block(ptr);
+        assertThat(block.checkChecksum(), "Heap corruption: removeRegion called on a block with invalid checksum");
+
+        if(!block.isFree() || block.hasPrev() || !block.hasNext(end) || block.getNext().getSize())
+        {
+            return false;
+        }
+
+        storeRemove(block);
+
+        if constexpr(trackStats)
+        {
+            this->totalUnits -= block.getSize();
+        }
+
+        info() << "Heap region removed at: " << ptr << "\n";
+        return true;
+    }
+
     /**
      * Allocate memory.
      *
@@ -436,7 +832,7 @@ public:
 
         const uintptr_t size = encodeRoundUp(max(sizeParam, Policy::freeHeaderSize) + Block::headerSize);
 
-        const Block block(this->Policy::findAndRemove(size, hot));
+        const Block block(storeFindAndRemove(size, hot));
 
         if(block.ptr == 0)
         {
@@ -449,6 +845,11 @@ public:
             assertThat(size <= block.getSize(), "Internal error");
             assertThat(block.isFree(), "Internal error");
 
+            if constexpr(trackStats)
+            {
+                this->nUsed++;
+            }
+
             if(hot)
             {
                 if(canSplit(block, size))
@@ -456,7 +857,7 @@ public:
                     const auto leftover(block.split(size, true));
                     leftover.updateNext(end);
                     leftover.updateChecksum();
-                    this->Policy::add(leftover);
+                    storeAdd(leftover);
                 }
             }
             else
@@ -469,7 +870,7 @@ public:
                     leftover.updateChecksum();
 
                     block.updateChecksum();
-                    this->Policy::add(block);
+                    storeAdd(block);
 
                     dbg() << "alloc(" << sizeParam << "): " << block.ptr << "\n";
                     return leftover.ptr;
@@ -486,6 +887,57 @@ public:
         }
     }
 
+    /**
+     * Allocate memory with an alignment larger than that of the heap.
+     *
+     * Allocates a block that is large enough to have an address with the required alignment
+     * in it (with enough room before it for a minimal free block), and then drops its front
+     * up to that address. The surplus at the end is also cut off.
+     *
+     * @param	size The amount (in bytes) to be allocated.
+     * @param	align The required alignment in bytes (has to be a power of two).
+     * @return	A pointer to the start of the allocated region, that can be used for the other
+     * 			operations like any block returned by _alloc_, or NULL on failure.
+     */
+    inline void* allocAligned(uintptr_t size, uintptr_t align)
+    {
+        assertThat(align && !(align & (align - 1)), "allocAligned(): Invalid alignment\n");
+
+        if(align <= alignment)
+        {
+            return alloc(size);
+        }
+
+        const uintptr_t minFront = decode(minEncodedBlockSize);
+
+        if(align > maxBlockSize - 2 * minFront || size > maxBlockSize - align - minFront)
+        {
+            warn() << "allocAligned(): Too large block requested !\n";
+            return nullptr;
+        }
+
+        /*
+         * The front can only be dropped up to the point where a minimal block is left
+         * behind, so a small block is reserved with the size of a minimal one at least.
+         */
+        void* ptr = alloc(((size < minFront) ? minFront : size) + align + minFront);
+
+        if(ptr == nullptr)
+        {
+            return nullptr;
+        }
+
+        if((uintptr_t)ptr & (align - 1))
+        {
+            const uintptr_t target = ((uintptr_t)ptr + minFront + align - 1) & ~(align - 1);
+            ptr = dropFront(ptr, target - (uintptr_t)ptr);
+            assertThat((uintptr_t)ptr == target, "Internal error: could not align block");
+        }
+
+        resize(ptr, size);
+        return ptr;
+    }
+
     /**
      * Release used memory.
      *
@@ -493,8 +945,10 @@ public:
      *
      * @param	r The pointer to the block that is to be freed.
      * 			It has to be a pointer returned by the method alloc, without any offset!
+     * @return	The free block that contains the released memory, it is different from
+     * 			the argument if it has been merged with the previous one.
      */
-    inline void free(void* r)
+    inline void* free(void* r)
     {
         assertThat(r, "free(): Invalid argument\n");
 
@@ -504,6 +958,11 @@ public:
 
         dbg() << "free(" <<  r << "): " << decode(block.getSize()) << " freed\n";
 
+        if constexpr(trackStats)
+        {
+            this->nUsed--;
+        }
+
         bool prevFree = block.hasPrev() && block.getPrev().isFree();
         bool nextFree = block.hasNext(end) && block.getNext().isFree();
 
@@ -519,9 +978,10 @@ public:
                 const auto next(block.getNext());
                 assertThat(next.checkChecksum(), "Heap corruption: next block has invalid checksum when freeing");
 
-                this->Policy::remove(next);
+                storeRemove(next);
 
                 prev.merge(next);
+                keepCursor(prev);
                 prev.updateNext(end);
             }
             else
@@ -532,10 +992,12 @@ public:
                 }
 
                 prev.merge(block);
+                keepCursor(prev);
                 prev.updateNext(end);
             }
 
-            this->Policy::update(oldSize, prev);
+            storeUpdate(oldSize, prev);
+            return prev.ptr;
         }
         else
         {
@@ -546,9 +1008,10 @@ public:
                 const Block next(block.getNext());
                 assertThat(next.checkChecksum(), "Heap corruption: next block has invalid checksum when freeing");
 
-                this->Policy::remove(next);
+                storeRemove(next);
 
                 block.merge(next);
+                keepCursor(block);
                 block.updateNext(end);
             }
             else
@@ -556,7 +1019,153 @@ public:
                 block.updateChecksum();
             }
 
-            this->Policy::add(block);
+            storeAdd(block);
+            return block.ptr;
+        }
+    }
+
+    /**
+     * Allocate multiple blocks of the same size.
+     *
+     * Takes a single free block that is large enough for all of them from the free store and
+     * splits it up, so that the free store is accessed only once (or twice if there is some
+     * leftover). The blocks are adjacent, in ascending address order. If there is no such large
+     * free block, the blocks are allocated one by one.
+     *
+     * @param	sizeParam The amount (in bytes) to be allocated for each block.
+     * @param	n The number of blocks to be allocated.
+     * @param	out The array that receives the pointers to the allocated blocks.
+     * @param	hot Prefer lower addresses if true higher if false
+     * @return	The number of blocks allocated (less than _n_ only if the heap is exhausted).
+     */
+    inline unsigned int allocBatch(uintptr_t sizeParam, unsigned int n, void** out, bool hot = false)
+    {
+        if(sizeParam > maxBlockSize || !n)
+        {
+            return 0;
+        }
+
+        const uintptr_t size = encodeRoundUp(max(sizeParam, Policy::freeHeaderSize) + Block::headerSize);
+        const uintptr_t total = size * n;
+
+        Block block(nullptr);
+
+        if(total / n == size && total <= maxBlockSize)
+        {
+            block = storeFindAndRemove(total, hot);
+        }
+
+        if(block.ptr == 0)
+        {
+            unsigned int ret = 0;
+
+            while(ret < n && (out[ret] = alloc(sizeParam, hot)))
+            {
+                ret++;
+            }
+
+            return ret;
+        }
+
+        assertThat(block.checkChecksum(), "Heap corruption: free block with invalid checksum fetched from storage");
+        assertThat(block.isFree(), "Internal error");
+
+        /*
+         * If not hot, the leftover is kept at the start like
+         * for single allocations, and the batch is cut from its end.
+         */
+        if(!hot && minEncodedBlockSize <= block.getSize() - total)
+        {
+            const auto batch(block.split(block.getSize() - total, false));
+            block.updateChecksum();
+            storeAdd(block);
+            block = batch;
+        }
+
+        for(unsigned int i = 0; i < n; i++)
+        {
+            if(i + 1 < n || canSplit(block, size))
+            {
+                const auto rest(block.split(size, true));
+
+                block.setFree(false);
+                block.updateChecksum();
+                out[i] = block.ptr;
+
+                block = rest;
+            }
+            else
+            {
+                block.setFree(false);
+                block.updateNext(end);
+                block.updateChecksum();
+                out[i] = block.ptr;
+
+                block = nullptr;
+            }
+        }
+
+        if(block.ptr)
+        {
+            block.updateNext(end);
+            block.updateChecksum();
+            storeAdd(block);
+        }
+
+        if constexpr(trackStats)
+        {
+            this->nUsed += n;
+        }
+
+        dbg() << "allocBatch(" << sizeParam << ", " << n << "): " << out[0] << "\n";
+        return n;
+    }
+
+    /**
+     * Release multiple blocks.
+     *
+     * The blocks are sorted by address first (the array is reordered in place), and the
+     * runs of adjacent ones are joined before releasing them, so the free store is accessed
+     * only once for each run, instead of once for each block.
+     *
+     * @param	ptrs The pointers to the blocks, as returned by _alloc_ (or _allocBatch_).
+     * @param	n The number of blocks.
+     */
+    inline void freeBatch(void** ptrs, unsigned int n)
+    {
+        if(n > 1)
+        {
+            heapSort<void*, &Heap::addressLess>(ptrs, n);
+        }
+
+        for(unsigned int i = 0; i < n;)
+        {
+            const Block first(ptrs[i]);
+            assertThat(first.checkChecksum(), "Heap corruption: freeBatch called on block with invalid checksum");
+            assertThat(!first.isFree(), "Heap corruption: freeBatch called on block that is already free");
+
+            Block last = first;
+
+            for(i++; i < n && last.getNext().ptr == Block(ptrs[i]).ptr; i++)
+            {
+                last = Block(ptrs[i]);
+                assertThat(last.checkChecksum(), "Heap corruption: freeBatch called on block with invalid checksum");
+                assertThat(!last.isFree(), "Heap corruption: freeBatch called on block that is already free");
+
+                if constexpr(trackStats)
+                {
+                    this->nUsed--;
+                }
+            }
+
+            if(last.ptr != first.ptr)
+            {
+                first.merge(last);
+                keepCursor(first);
+                first.updateNext(end);
+            }
+
+            free(first.ptr);
         }
     }
 
@@ -588,6 +1197,12 @@ public:
 
         dbg() << "resize(" <<  ptr << "): " << (decode(block.getSize()) - Block::headerSize) << " -> " << newSizeParam;
 
+        if(newSizeParam > maxBlockSize)
+        {
+            warn() << "resize(): Too large block requested !\n";
+            return decode(block.getSize()) - Block::headerSize;
+        }
+
         uintptr_t requestedSize = encodeRoundUp(max(newSizeParam, Policy::freeHeaderSize) + Block::headerSize);
 
         if(requestedSize < block.getSize())
@@ -604,8 +1219,9 @@ public:
 
                     if(next.isFree())
                     {
-                        this->Policy::remove(next);
+                        storeRemove(next);
                         leftover.merge(next);
+                        keepCursor(leftover);
                     }
                     else
                     {
@@ -619,7 +1235,7 @@ public:
                     leftover.updateChecksum();
                 }
 
-                this->Policy::add(leftover);
+                storeAdd(leftover);
             }
         }
         else if(block.getSize() < requestedSize)
@@ -633,12 +1249,13 @@ public:
                 {
                     const auto newSliceSize = requestedSize - block.getSize();
 
-                    this->Policy::remove(next);
+                    storeRemove(next);
 
                     if(canSplit(next, newSliceSize))
                     {
                         const auto oldNextNext(next.getNext());
                         block.setSize(requestedSize);
+                        keepCursor(block);
                         block.updateChecksum();
 
                         const auto newNext(block.getNext());
@@ -649,11 +1266,12 @@ public:
 
                         newNext.updateNext(end);
 
-                        this->Policy::add(newNext);
+                        storeAdd(newNext);
                     }
                     else
                     {
                         block.merge(next);
+                        keepCursor(block);
                         block.updateNext(end);
                     }
                 }
@@ -663,6 +1281,76 @@ public:
         return decode(block.getSize()) - Block::headerSize;
     }
 
+    /**
+     * Resize an allocation, moving the data if needed.
+     *
+     * Works like the _realloc_ of the stdlibc. It tries to do the resizing in the following
+     * order, falling back to the next one only if the previous is not possible:
+     *
+     *  1. In place, the same way as the _resize_ method does (growing into the next block).
+     *  2. By growing the block backwards into the previous block (and also into the next one
+     *     if needed), if it is free. The data is moved to the start of the previous block.
+     *  3. By allocating a new block, copying the data over and releasing the old one.
+     *
+     * @param	ptr The pointer to the block to be resized. It has to be a pointer returned by
+     * 			the method alloc, without any offset! If it is NULL a new block is allocated.
+     * @param 	newSizeParam The requested new size of the block.
+     * @return	The new location of the data or NULL if there is not enough space, in which case
+     * 			the original block is left intact.
+     */
+    inline void* reallocate(void* ptr, uintptr_t newSizeParam)
+    {
+        if(!ptr)
+        {
+            return alloc(newSizeParam);
+        }
+
+        if(newSizeParam > maxBlockSize)
+        {
+            warn() << "reallocate(): Too large block requested !\n";
+            return nullptr;
+        }
+
+        if(newSizeParam <= resize(ptr, newSizeParam))
+        {
+            return ptr;
+        }
+
+        const Block block(ptr);
+        const uintptr_t oldPayload = decode(block.getSize()) - Block::headerSize;
+        const uintptr_t requestedSize = encodeRoundUp(max(newSizeParam, Policy::freeHeaderSize) + Block::headerSize);
+
+        if(block.hasPrev() && block.getPrev().isFree())
+        {
+            const auto prev(block.getPrev());
+            assertThat(prev.checkChecksum(), "Heap corruption: previous block has invalid checksum when reallocating");
+
+            const bool nextFree = block.hasNext(end) && block.getNext().isFree();
+            const auto next(block.getNext());
+            assertThat(!nextFree || next.checkChecksum(), "Heap corruption: next block has invalid checksum when reallocating");
+
+            if(requestedSize <= uintptr_t(prev.getSize()) + block.getSize() + (nextFree ? next.getSize() : 0u))
+            {
+                dbg() << "reallocate(" <<  ptr << "): " << oldPayload << " -> " << newSizeParam << " backwards\n";
+
+                moveIntoPrev(block, nextFree);
+                resize(prev.ptr, newSizeParam);
+                return prev.ptr;
+            }
+        }
+
+        if(void* ret = alloc(newSizeParam))
+        {
+            dbg() << "reallocate(" <<  ptr << "): " << oldPayload << " -> " << newSizeParam << " copied\n";
+
+            movePayload(ret, ptr, oldPayload);
+            free(ptr);
+            return ret;
+        }
+
+        return nullptr;
+    }
+
     /**
      * Decrease size of a block by moving its starting address higher and leaving the end
      * of the allocation range at its current address.
@@ -701,8 +1389,9 @@ public:
 
                 const auto oldSize = prev.getSize();
                 prev.setSize(prev.getSize() + splitOffset);
+                keepCursor(prev);
                 prev.updateChecksum();
-                this->Policy::update(oldSize, prev);
+                storeUpdate(oldSize, prev);
 
                 const auto newBlock(prev.getNext());
                 newBlock.setFree(false);
@@ -718,7 +1407,7 @@ public:
                 const auto newBlock(block.split(splitOffset, false));
                 block.setFree(true);
                 block.updateChecksum();
-                this->Policy::add(block);
+                storeAdd(block);
 
                 newBlock.updateChecksum();
                 newBlock.updateNext(end);
@@ -729,10 +1418,246 @@ public:
         return block.ptr;
     }
 
+    /**
+     * Move a used block backwards, if the block before it is free.
+     *
+     * The block is moved to the start of the previous free block, the data is moved along
+     * with it, and the free space is placed after it (merged with the next block if that
+     * is free too). The time it takes is proportional to the size of the block.
+     *
+     * @param	ptr The pointer to the block to be moved.
+     * 			It has to be a pointer returned by the method alloc, without any offset!
+     * @return	The new location of the block, the same as the argument if it could not be moved.
+     */
+    inline void* slideBack(void* ptr)
+    {
+        assertThat(ptr, "slideBack(): Null argument\n");
+
+        const Block block(ptr);
+        assertThat(block.checkChecksum(), "Heap corruption: slideBack called on a block with invalid checksum");
+        assertThat(!block.isFree(), "Heap corruption: slideBack called on free block");
+
+        if(!block.hasPrev() || !block.getPrev().isFree())
+        {
+            return ptr;
+        }
+
+        assertThat(block.getPrev().checkChecksum(), "Heap corruption: previous block has invalid checksum when sliding");
+
+        const auto size = block.getSize();
+        const auto moved(moveIntoPrev(block, false));
+        const auto leftover(moved.split(size, true));
+        moved.updateChecksum();
+
+        if(leftover.hasNext(end) && leftover.getNext().isFree())
+        {
+            const auto next(leftover.getNext());
+            assertThat(next.checkChecksum(), "Heap corruption: next block has invalid checksum when sliding");
+
+            storeRemove(next);
+            leftover.merge(next);
+            keepCursor(leftover);
+        }
+        else
+        {
+            leftover.updateChecksum();
+        }
+
+        leftover.updateNext(end);
+        storeAdd(leftover);
+
+        return moved.ptr;
+    }
+
+    /**
+     * Check the integrity of some blocks.
+     *
+     * Verifies a limited number of blocks, continuing from where the previous call left off,
+     * so that the whole heap can be checked in small steps (for example, when idle). For each
+     * block the checksum is validated, along with the consistency of the links between it and
+     * its neighbors, and that there are no adjacent free blocks. Corruption is reported the same
+     * way as by the other operations, via the _assertThat_ of the Trace<AllHeapsTrace>.
+     *
+     * Available only if the _useChecksum_ option is enabled. The region specified on initialization
+     * is verified, the ones added via _addRegion_ are not.
+     *
+     * @param	budget The maximal number of blocks to be checked.
+     * @return	True if the last block has been reached, in which case the next call starts over
+     * 			from the first block.
+     */
+    inline bool verifyStep(unsigned int budget)
+    {
+        static_assert(useChecksum, "Integrity verification requires checksumming to be enabled for this heap");
+
+        while(budget--)
+        {
+            const Block block(this->verifyCursor);
+
+            assertThat(block.checkChecksum(), "Heap corruption: invalid checksum found during verification");
+            assertThat(block.getSize() && block.getNext().ptr <= end.ptr, "Heap corruption: invalid block size found during verification");
+            assertThat(block.hasPrev() == (block.ptr != this->verifyFirst), "Heap corruption: invalid start block found during verification");
+            assertThat(!block.hasPrev() || block.getPrev().getNext().ptr == block.ptr, "Heap corruption: inconsistent previous link found during verification");
+
+            if(!block.hasNext(end))
+            {
+                this->verifyCursor = this->verifyFirst;
+                return true;
+            }
+
+            const auto next(block.getNext());
+            assertThat(next.checkChecksum(), "Heap corruption: invalid checksum found during verification");
+            assertThat(next.getPrev().ptr == block.ptr, "Heap corruption: inconsistent next link found during verification");
+            assertThat(!block.isFree() || !next.isFree(), "Heap corruption: unmerged free blocks found during verification");
+
+            this->verifyCursor = next.ptr;
+        }
+
+        return false;
+    }
+
+    /**
+     * Give back the unused memory inside the free blocks of a region to the system.
+     *
+     * Walks the blocks of the region and for every free one that spans at least a whole
+     * page (besides its header), it calls the _discard_ function with the range of pages
+     * it covers. The headers of the blocks are left intact, so the heap stays fully
+     * functional, the discarded pages are reused when they get allocated again.
+     *
+     * @param	start The start of the region, as specified on initialization (or to _addRegion_).
+     * @param	pageSize The granularity of the discarding (has to be a power of two).
+     * @param	discard A callable taking a page aligned (void* start, uintptr_t length) range,
+     * 			for example the _discard_ method of the MmapProvider (that does an _madvise_).
+     * @return	The number of bytes discarded.
+     */
+    template<class Discard>
+    inline uintptr_t trim(void* start, uintptr_t pageSize, Discard &&discard)
+    {
+        uintptr_t ret = 0;
+
+        for(void* ptr = firstBlock(start); ptr; ptr = nextBlock(ptr))
+        {
+            if(isFree(ptr))
+            {
+                ret += discardPages(Block(ptr), pageSize, discard);
+            }
+        }
+
+        return ret;
+    }
+
+    /**
+     * Give back the unused memory inside a single free block to the system.
+     *
+     * It can be used right after a release on the block returned by _free_, to keep the
+     * memory footprint low without walking the whole heap.
+     *
+     * @param	ptr A free block (as returned by _free_).
+     * @param	minSize The block is only processed if it is at least this large (in bytes).
+     * @see		trim for the rest of the details.
+     */
+    template<class Discard>
+    inline uintptr_t trimBlock(void* ptr, uintptr_t pageSize, Discard &&discard, uintptr_t minSize = 0)
+    {
+        const Block block(ptr);
+        assertThat(block.checkChecksum(), "Heap corruption: trimBlock called on a block with invalid checksum");
+        assertThat(block.isFree(), "Heap corruption: trimBlock called on a used block");
+
+        return (minSize <= decode(block.getSize())) ? discardPages(block, pageSize, discard) : 0;
+    }
+
+    /**
+     * Get the first block.
+     *
+     * Together with _nextBlock_ and _isFree_ it enables walking all the blocks
+     * of the heap, for maintenance operations.
+     *
+     * @param	start The start of the heap space, as specified on initialization.
+     */
+    static inline void* firstBlock(void* start) {
+        return (char*)alignUp((uintptr_t)((char*)start + Block::headerSize));
+    }
+
+    /**
+     * Get the block physically following the specified (free or used) one.
+     *
+     * @return	The next block, or NULL if this is the last one (of its region).
+     */
+    inline void* nextBlock(void* ptr) const
+    {
+        const Block block(ptr);
+        assertThat(block.checkChecksum(), "Heap corruption: invalid checksum found during block walk");
+        return (block.hasNext(end) && block.getNext().getSize()) ? block.getNext().ptr : nullptr;
+    }
+
+    /**
+     * Is the specified block (obtained by walking the blocks) free?
+     */
+    static inline bool isFree(void* ptr) {
+        return Block(ptr).isFree();
+    }
+
+    /**
+     * Get usable size of an allocation.
+     *
+     * @param	ptr The pointer to the block whose size is to be queried.
+     * 			It has to be a pointer returned by the method alloc, without any offset!
+     * @return	The number of bytes that can be used by the application, it is never
+     * 			less than the amount that was requested when the block was allocated.
+     *
+     * @note	Only the size field of the block is read, which is modified only by operations
+     * 			on the block itself, thus it does not need to be synchronized with operations
+     * 			done on other blocks. For the same reason the checksum is not verified here.
+     */
+    static inline uintptr_t getSize(void* ptr)
+    {
+        assertThat(ptr, "getSize(): Null argument\n");
+
+        const Block block(ptr);
+        assertThat(!block.isFree(), "Heap corruption: getSize called on a free block");
+
+        return decode(block.getSize()) - Block::headerSize;
+    }
+
+    /**
+     * Get usable size of an allocation of a given size.
+     *
+     * @param	size The amount (in bytes) to be requested, not more than the largest block allowed.
+     * @return	The usable size (as reported by _getSize_) of the block that is allocated for
+     * 			the request, unless it is left larger because the remainder was too small to
+     * 			be split off.
+     */
+    static constexpr uintptr_t usableSize(uintptr_t size) {
+        return decode(encodeRoundUp(max(size, Policy::freeHeaderSize) + Block::headerSize)) - Block::headerSize;
+    }
+
+    /**
+     * Get usage statistics.
+     *
+     * Available only if the _trackStats_ option is enabled. Uses the counters that are
+     * updated by every operation, and queries the longest free block from the policy,
+     * so it does not walk the blocks of the heap.
+     *
+     * @return	The current statistics, the same as the ones calculated by the getStats(void*).
+     */
+    inline HeapStat getStats()
+    {
+        static_assert(trackStats, "Statistics tracking is not enabled for this heap");
+
+        const uintptr_t longest = this->Policy::longestSize();
+
+        return HeapStat
+        {
+            longest ? decode(longest) - Block::headerSize : 0,
+            decode(this->freeUnits) - this->nFree * Block::headerSize,
+            this->nUsed,
+            decode(this->totalUnits - this->freeUnits) - this->nUsed * Block::headerSize
+        };
+    }
+
     /** @cond */
     inline HeapStat getStats(void *start)
     {
-        Block block((char*)alignUp((uintptr_t)((char*)start + Block::headerSize)));
+        Block block(firstBlock(start));
         HeapStat ret{0, 0, 0, 0};
 
         bool prevFree = false;
@@ -760,9 +1685,9 @@ public:
                 prevFree = false;
             }
 
-            if(block.hasNext(end))
+            if(void* next = nextBlock(block.ptr))
             {
-                block = block.getNext();
+                block = Block(next);
             }
             else
             {
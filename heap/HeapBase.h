@@ -86,10 +86,59 @@ struct HeapBase
          * Get the size of the payload of this block.
          * @see	Heap for the details.
          */
-        inline unsigned int getSize() const  {
+        inline SizeType getSize() const  {
             return ptr[nextFieldIdx] & ~sizeMsb;
         }
     };
+
+    /**
+     * Cached size of the longest free block.
+     *
+     * For the policies that can not find their longest block in constant time. The value
+     * is kept exact by the additions (and growths) of free blocks, the removal of a block
+     * of the cached size only marks it stale. A stale value is an upper bound, the policy
+     * needs to look up the actual one (and _set_ it) on the next query.
+     */
+    class LongestFree
+    {
+        uintptr_t size = 0;
+        bool known = true;
+
+    public:
+        inline void set(uintptr_t s)
+        {
+            size = s;
+            known = true;
+        }
+
+        inline void added(uintptr_t s)
+        {
+            if(size <= s)
+                set(s);
+        }
+
+        inline void removed(uintptr_t s)
+        {
+            if(s == size)
+                known = false;
+        }
+
+        inline void changed(uintptr_t oldSize, uintptr_t newSize)
+        {
+            if(size <= newSize)
+                set(newSize);
+            else if(oldSize == size)
+                known = false;
+        }
+
+        inline bool isKnown() const {
+            return known;
+        }
+
+        inline uintptr_t get() const {
+            return size;
+        }
+    };
 };
 
 }
@@ -0,0 +1,173 @@
+/*******************************************************************************
+ *
+ * Copyright (c) 2026 Tamás Seller. All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *******************************************************************************/
+
+#ifndef PET_HEAP_MEMORYRESOURCE_H_
+#define PET_HEAP_MEMORYRESOURCE_H_
+
+#include "platform/Compiler.h"
+
+#include <memory_resource>
+#include <new>
+
+#include <stdint.h>
+#include <stdlib.h>
+
+namespace pet {
+
+/**
+ * Lock type for the memory resources that are not shared between threads.
+ */
+struct NoLock
+{
+    really_inline void lock() {}
+    really_inline void unlock() {}
+};
+
+namespace detail
+{
+    /// Report allocation failure the way the standard memory resources do.
+    [[noreturn]] static inline void memoryResourceExhausted()
+    {
+#if defined(__cpp_exceptions) || defined(_CPPUNWIND)
+        throw std::bad_alloc();
+#else
+        abort();
+#endif
+    }
+
+    /// Holds the lock while in scope.
+    template<class Mutex>
+    class ResourceLock
+    {
+        Mutex &mutex;
+
+    public:
+        really_inline ResourceLock(Mutex &mutex): mutex(mutex) { mutex.lock(); }
+        really_inline ~ResourceLock() { mutex.unlock(); }
+        ResourceLock(const ResourceLock&) = delete;
+    };
+}
+
+/**
+ * Polymorphic memory resource adapter for the Heap.
+ *
+ * Makes it possible to use a heap with the _std::pmr_ containers. Requests with alignment
+ * not greater than that of the heap are served by _alloc_, the ones with larger alignment
+ * by _allocAligned_.
+ *
+ * @tparam	Heap The type of the heap.
+ * @tparam	Mutex The lock to be held during the operations, the default _NoLock_ does nothing,
+ * 			for a heap shared between threads a real one (like std::mutex) can be used.
+ */
+template<class Heap, class Mutex = NoLock>
+class HeapMemoryResource: public std::pmr::memory_resource
+{
+    Heap &heap;
+    Mutex mutex;
+
+    void* do_allocate(size_t bytes, size_t align) override
+    {
+        void* ret;
+
+        {
+            detail::ResourceLock<Mutex> lock(mutex);
+            ret = (align <= Heap::alignment) ? heap.alloc(bytes) : heap.allocAligned(bytes, align);
+        }
+
+        if(!ret)
+        {
+            detail::memoryResourceExhausted();
+        }
+
+        return ret;
+    }
+
+    void do_deallocate(void* ptr, size_t, size_t) override
+    {
+        detail::ResourceLock<Mutex> lock(mutex);
+        heap.free(ptr);
+    }
+
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+        return this == &other;
+    }
+
+public:
+    /**
+     * Create an adapter for a heap, that must outlive it.
+     */
+    inline HeapMemoryResource(Heap &heap): heap(heap) {}
+};
+
+/**
+ * Polymorphic memory resource adapter for the BuddyAllocator (and the ConcurrentBuddyAllocator).
+ *
+ * The blocks of a buddy allocator are naturally aligned to their size (up to the alignment
+ * of the managed area), so requests with larger alignment than their size are simply served
+ * with a larger block.
+ *
+ * @tparam	Buddy The type of the allocator.
+ * @tparam	Mutex The lock to be held during the operations, the default _NoLock_ does nothing,
+ * 			it is not needed for the ConcurrentBuddyAllocator even if it is used by multiple threads.
+ */
+template<class Buddy, class Mutex = NoLock>
+class BuddyMemoryResource: public std::pmr::memory_resource
+{
+    Buddy &buddy;
+    Mutex mutex;
+
+    void* do_allocate(size_t bytes, size_t align) override
+    {
+        const size_t size = (bytes < align) ? align : bytes;
+        void* ret = nullptr;
+
+        if(align <= Buddy::maxAlignment && size <= UINT32_MAX)
+        {
+            detail::ResourceLock<Mutex> lock(mutex);
+            ret = buddy.allocate(static_cast<uint32_t>(size));
+        }
+
+        if(!ret)
+        {
+            detail::memoryResourceExhausted();
+        }
+
+        return ret;
+    }
+
+    void do_deallocate(void* ptr, size_t, size_t) override
+    {
+        detail::ResourceLock<Mutex> lock(mutex);
+        buddy.free(ptr);
+    }
+
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+        return this == &other;
+    }
+
+public:
+    /**
+     * Create an adapter for an allocator, that must outlive it.
+     */
+    inline BuddyMemoryResource(Buddy &buddy): buddy(buddy) {}
+};
+
+}
+
+#endif /* PET_HEAP_MEMORYRESOURCE_H_ */
@@ -0,0 +1,144 @@
+/*******************************************************************************
+ *
+ * Copyright (c) 2026 Tamás Seller. All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *******************************************************************************/
+
+#ifndef PET_HEAP_OWNEDHEAP_H_
+#define PET_HEAP_OWNEDHEAP_H_
+
+#include "data/SharedAtomicList.h"
+#include "meta/Resettable.h"
+
+#include "platform/Compiler.h"
+
+#include <stdint.h>
+
+namespace pet {
+
+/**
+ * Heap owned by a single thread, that can take back blocks from any thread.
+ *
+ * All the operations of the underlying heap are to be used only by the owner thread
+ * (or context), so they do not need to be guarded by a lock. Other threads can release
+ * blocks via the _remoteFree_ method, which only pushes the block to a lock-free list
+ * (that uses the payload of the block for the link). The owner puts back these blocks
+ * into the heap in batches, when it next allocates (or explicitly, via _drain_).
+ *
+ * This fits the producer-consumer pattern well, where the buffers are allocated by one
+ * thread and released by another, without any locking.
+ *
+ * @tparam	Heap The type of the underlying heap (or a wrapper like the GrowingHeap), whose
+ * 			minimal block size has to be enough to store a pointer (which is true for all
+ * 			the builtin policies).
+ *
+ * @note	The remotely released blocks are counted as used until they are drained.
+ */
+template<class Heap>
+class OwnedHeap: public Heap
+{
+    SharedAtomicList remote;
+
+    /// The number of blocks collected from the remote list before putting them back at once.
+    static constexpr unsigned int batchSize = 64;
+
+    /// Put back the blocks in one batch, if the heap supports that.
+    template<class H = Heap>
+    inline auto release(void** ptrs, unsigned int n, int) -> decltype(static_cast<H*>(this)->freeBatch(ptrs, n))
+    {
+        H::freeBatch(ptrs, n);
+    }
+
+    /// Put back the blocks one by one, for the other heaps.
+    template<class H = Heap>
+    inline void release(void** ptrs, unsigned int n, long)
+    {
+        for(unsigned int i = 0; i < n; i++)
+        {
+            H::free(ptrs[i]);
+        }
+    }
+
+public:
+    using Heap::Heap;
+
+    /**
+     * Allocate memory, after putting back the remotely released blocks.
+     *
+     * Must only be called by the owner.
+     *
+     * @see	Heap::alloc for the details.
+     */
+    inline void* alloc(uintptr_t size, bool hot = false)
+    {
+        drain();
+        return Heap::alloc(size, hot);
+    }
+
+    /**
+     * Release a block from a thread other than the owner.
+     *
+     * It can be called concurrently from any number of threads (and also by the owner).
+     *
+     * @param	ptr The pointer to the block, as returned by _alloc_.
+     */
+    inline void remoteFree(void* ptr)
+    {
+        auto element = new(ptr, NewOperatorDisambiguator()) SharedAtomicList::Element;
+        remote.push(element);
+    }
+
+    /**
+     * Put back the remotely released blocks into the heap.
+     *
+     * The blocks are collected in batches and released via _freeBatch_, which joins the
+     * runs of adjacent blocks first, if the heap has it (otherwise one by one).
+     *
+     * Must only be called by the owner.
+     */
+    inline void drain()
+    {
+        if(likely(remote.isEmpty()))
+        {
+            return;
+        }
+
+        auto reader = remote.read();
+        void* batch[batchSize];
+        unsigned int n = 0;
+
+        while(auto element = reader.peek())
+        {
+            reader.pop();
+            batch[n++] = element;
+
+            if(n == batchSize)
+            {
+                release(batch, n, 0);
+                n = 0;
+            }
+        }
+
+        if(n)
+        {
+            release(batch, n, 0);
+        }
+    }
+};
+
+}
+
+#endif /* PET_HEAP_OWNEDHEAP_H_ */
@@ -0,0 +1,294 @@
+/*******************************************************************************
+ *
+ * Copyright (c) 2026 Tamás Seller. All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *******************************************************************************/
+
+#ifndef PET_HEAP_PERSISTENTHEAP_H_
+#define PET_HEAP_PERSISTENTHEAP_H_
+
+#include "heap/Heap.h"
+
+#include "managed/OffsetPtr.h"
+
+#include "platform/Compiler.h"
+
+#include <atomic>
+
+#include <stdint.h>
+
+namespace pet {
+
+/**
+ * Heap that keeps its state in a persistent area, like a memory mapped file.
+ *
+ * The area starts with a small header, that identifies the format and holds the root
+ * pointer, followed by the heap space. When the area is opened for the first time the
+ * heap is initialized in it, later it is taken over as is (@see Heap::attach), so the
+ * data structures stored in it are available right away, without rebuilding them. The
+ * area can be mapped at a different address each time, so the objects stored in the heap
+ * need to refer to each other through position independent links, like the OffsetPtr.
+ *
+ * The application can find its data via the root pointer, that is stored in the header.
+ *
+ * Crash consistency: the operations of the heap are not atomic, so the header has a flag
+ * that is set for the duration of every operation. If the flag is found set on opening,
+ * an operation was interrupted (the block involved may be lost), which can be queried via
+ * _wasInterrupted_. The structure of the heap is always verified on opening, so a heap left
+ * in an inconsistent state is rejected. Enabling the checksums of the heap makes this check
+ * more thorough. The durability against the crash of the system (as opposed to the process)
+ * depends on the mapped area being written back, so the area should be synchronized (by
+ * _msync_ for a file) at the points where the application data is consistent.
+ *
+ * @tparam	Heap The type of the underlying heap, the same type has to be used for all
+ * 			opening of the same area.
+ */
+template<class Heap>
+class PersistentHeap: pet::Trace<AllHeapsTrace>
+{
+    /**
+     * Header of the persistent area.
+     */
+    struct Header
+    {
+        static constexpr uint32_t magicValue = 0x50455448; // 'PETH'
+        static constexpr uint32_t currentVersion = 1;
+
+        uint32_t magic;
+        uint32_t version;
+        uint32_t alignment;
+        volatile uint32_t busy;
+        uint64_t size;
+        OffsetPtr<void> root;
+    };
+
+    /// The size of the header, keeps the alignment of the heap.
+    static constexpr uintptr_t headerSize = (sizeof(Header) + Heap::alignment - 1) & ~(Heap::alignment - 1);
+
+    Heap heap;
+    Header* header = nullptr;
+    bool interrupted = false;
+
+    /**
+     * Marks the duration of an operation in the header.
+     */
+    class Operation
+    {
+        Header* header;
+
+    public:
+        really_inline Operation(Header* header): header(header)
+        {
+            header->busy = 1;
+            std::atomic_signal_fence(std::memory_order_seq_cst);
+        }
+
+        really_inline ~Operation()
+        {
+            std::atomic_signal_fence(std::memory_order_seq_cst);
+            header->busy = 0;
+        }
+
+        Operation(const Operation&) = delete;
+    };
+
+    really_inline void* space() const {
+        return reinterpret_cast<char*>(header) + headerSize;
+    }
+
+    /**
+     * Check whether the header is all zeroes, like a newly created file.
+     */
+    static inline bool isBlank(const void* area)
+    {
+        auto p = static_cast<const char*>(area);
+
+        for(auto i = 0u; i < sizeof(Header); i++)
+        {
+            if(p[i])
+            {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+public:
+    /**
+     * Create a closed heap, that needs to be opened before use.
+     */
+    inline PersistentHeap() = default;
+
+    PersistentHeap(const PersistentHeap&) = delete;
+
+    /**
+     * Open the heap in a persistent area.
+     *
+     * If the area starts with a valid header the existing heap is taken over after verifying it.
+     * Otherwise a new one is created in it, but only if the area is blank (the header is all
+     * zeroes, like in a newly created file) or the caller explicitly asks for formatting, so
+     * that mapping the wrong file does not destroy its contents.
+     *
+     * @param	area The start of the area (aligned to the alignment of the heap).
+     * @param	size The size of the area, the same for every opening.
+     * @param	format Create a new heap even if the area contains some other data (which is lost).
+     * @return	True on success, false if the area contains an incompatible or inconsistent heap,
+     * 			or unrecognized data without _format_ being set.
+     */
+    inline bool open(void* area, uintptr_t size, bool format = false)
+    {
+        assertThat(headerSize < size, "PersistentHeap::open(): Area too small\n");
+        assertThat(!(reinterpret_cast<uintptr_t>(area) & (Heap::alignment - 1)), "PersistentHeap::open(): Misaligned area\n");
+
+        header = static_cast<Header*>(area);
+
+        if(header->magic != Header::magicValue)
+        {
+            if(!format && !isBlank(area))
+            {
+                warn() << "PersistentHeap::open(): Unrecognized data in area\n";
+                header = nullptr;
+                return false;
+            }
+
+            heap.init(space(), size - headerSize);
+
+            header->version = Header::currentVersion;
+            header->alignment = Heap::alignment;
+            header->busy = 0;
+            header->size = size;
+            header->root = nullptr;
+            std::atomic_signal_fence(std::memory_order_seq_cst);
+            header->magic = Header::magicValue;
+
+            interrupted = false;
+            return true;
+        }
+
+        if(header->version != Header::currentVersion || header->alignment != Heap::alignment || header->size != size)
+        {
+            warn() << "PersistentHeap::open(): Incompatible heap format\n";
+            header = nullptr;
+            return false;
+        }
+
+        interrupted = header->busy != 0;
+
+        if(interrupted)
+        {
+            warn() << "PersistentHeap::open(): Last operation was interrupted\n";
+        }
+
+        if(!heap.attach(space(), size - headerSize))
+        {
+            warn() << "PersistentHeap::open(): Inconsistent heap\n";
+            header = nullptr;
+            return false;
+        }
+
+        header->busy = 0;
+        return true;
+    }
+
+    /**
+     * Check whether an operation was interrupted before the last opening.
+     */
+    really_inline bool wasInterrupted() const {
+        return interrupted;
+    }
+
+    /**
+     * Get the root object.
+     *
+     * @return	The object set by _setRoot_, or NULL if it has not been set.
+     */
+    template<class T = void>
+    really_inline T* getRoot() const {
+        return static_cast<T*>(header->root.get());
+    }
+
+    /**
+     * Set the root object, through which the application can find its data after reopening.
+     *
+     * @param	root An object allocated from this heap, or NULL.
+     */
+    really_inline void setRoot(void* root) {
+        header->root = root;
+    }
+
+    /** @copydoc Heap::alloc */
+    inline void* alloc(uintptr_t size, bool hot = false)
+    {
+        Operation op(header);
+        return heap.alloc(size, hot);
+    }
+
+    /**
+     * Release memory.
+     *
+     * @see	Heap::free for the details.
+     */
+    inline void free(void* ptr)
+    {
+        Operation op(header);
+        heap.free(ptr);
+    }
+
+    /** @copydoc Heap::resize */
+    inline uintptr_t resize(void* ptr, uintptr_t size)
+    {
+        Operation op(header);
+        return heap.resize(ptr, size);
+    }
+
+    /** @copydoc Heap::reallocate */
+    inline void* reallocate(void* ptr, uintptr_t size)
+    {
+        Operation op(header);
+        return heap.reallocate(ptr, size);
+    }
+
+    /**
+     * Get usable size of an allocation.
+     *
+     * @see	Heap::getSize for the details.
+     */
+    static inline uintptr_t getSize(void* ptr) {
+        return Heap::getSize(ptr);
+    }
+
+    /**
+     * Get the usage statistics of the heap (by walking the blocks).
+     */
+    inline HeapStat getStats() {
+        return heap.getStats(space());
+    }
+
+    /**
+     * Allocate memory for an object of type T.
+     */
+    template<class T>
+    inline void* allocFor()
+    {
+        static_assert(alignof(T) <= Heap::alignment, "Object requires larger alignment than that of the heap");
+        return alloc(sizeof(T));
+    }
+};
+
+}
+
+#endif /* PET_HEAP_PERSISTENTHEAP_H_ */
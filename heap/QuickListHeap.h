@@ -0,0 +1,171 @@
+/*******************************************************************************
+ *
+ * Copyright (c) 2026 Tamás Seller. All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *******************************************************************************/
+
+#ifndef PET_HEAP_QUICKLISTHEAP_H_
+#define PET_HEAP_QUICKLISTHEAP_H_
+
+#include "platform/Compiler.h"
+
+#include <stdint.h>
+
+namespace pet {
+
+/**
+ * Heap with deferred coalescing of small blocks.
+ *
+ * The small blocks released are not given back to the underlying heap (which would
+ * merge them with their free neighbors right away), but are put on a LIFO quick list
+ * according to their exact size (in units of the alignment). Subsequent requests of
+ * the same size are then served from these lists directly, without searching, splitting
+ * and merging, and with the most recently used (possibly cache-hot) block.
+ *
+ * The size classes are those of the underlying heap: a request is looked up under the
+ * usable size of the block that the heap would allocate for it, and a released block is
+ * filed under its own usable size, so a block is always found by a request of its size.
+ *
+ * The cached blocks are given back to the underlying heap when an allocation can not be
+ * satisfied otherwise, or explicitly via _flush_. The length of the lists is limited, the
+ * blocks released to a full list go to the underlying heap, so the amount of memory held
+ * is bounded even if the underlying heap never fails (like the GrowingHeap).
+ *
+ * @tparam	Heap The type of the underlying heap (or a wrapper like the GrowingHeap), whose
+ * 			minimal block size has to be enough to store a pointer (which is true for all
+ * 			the builtin policies).
+ * @tparam	maxSize The size (in bytes) of the largest request handled by the quick lists.
+ * @tparam	maxLength The maximal number of blocks kept on a single list.
+ *
+ * @note	The blocks on the quick lists are counted as used by the underlying heap.
+ */
+template<class Heap, uintptr_t maxSize = 128, uintptr_t maxLength = 32>
+class QuickListHeap: public Heap
+{
+    static constexpr uintptr_t minUsable = Heap::usableSize(0);
+    static constexpr uintptr_t maxUsable = Heap::usableSize(maxSize);
+    static constexpr uintptr_t nLists = (maxUsable - minUsable) / Heap::alignment + 1;
+
+    /// The link stored in the payload of a cached block.
+    struct Entry
+    {
+        Entry* next;
+    };
+
+    struct List
+    {
+        Entry* first = nullptr;
+        uintptr_t length = 0;
+    };
+
+    List lists[nLists];
+
+    /// The index of the list for blocks of the given usable size.
+    static really_inline uintptr_t listIndex(uintptr_t usable) {
+        return (usable - minUsable) / Heap::alignment;
+    }
+
+public:
+    using Heap::Heap;
+
+    /**
+     * Allocate memory.
+     *
+     * Small requests are served from the quick list of the matching size if it is not
+     * empty, the rest (and the misses) go to the underlying heap. If that fails, the
+     * quick lists are flushed and the allocation is retried.
+     *
+     * @see	Heap::alloc for the details.
+     */
+    inline void* alloc(uintptr_t size, bool hot = false)
+    {
+        if(size <= maxSize)
+        {
+            List &list = lists[listIndex(Heap::usableSize(size))];
+
+            if(Entry* entry = list.first)
+            {
+                list.first = entry->next;
+                list.length--;
+                return entry;
+            }
+        }
+
+        if(void* ret = Heap::alloc(size, hot))
+        {
+            return ret;
+        }
+
+        return flush() ? Heap::alloc(size, hot) : nullptr;
+    }
+
+    /**
+     * Release memory.
+     *
+     * Small blocks are put on the quick list for their usable size (unless it
+     * is full), the rest are released to the underlying heap.
+     *
+     * @param	ptr The pointer to the block, as returned by _alloc_.
+     */
+    inline void free(void* ptr)
+    {
+        const uintptr_t size = Heap::getSize(ptr);
+
+        if(size <= maxUsable)
+        {
+            List &list = lists[listIndex(size)];
+
+            if(list.length < maxLength)
+            {
+                Entry* entry = static_cast<Entry*>(ptr);
+                entry->next = list.first;
+                list.first = entry;
+                list.length++;
+                return;
+            }
+        }
+
+        Heap::free(ptr);
+    }
+
+    /**
+     * Give back all the cached blocks to the underlying heap.
+     *
+     * @return	True if there were any blocks cached.
+     */
+    inline bool flush()
+    {
+        bool ret = false;
+
+        for(auto &list: lists)
+        {
+            while(Entry* entry = list.first)
+            {
+                list.first = entry->next;
+                Heap::free(entry);
+                ret = true;
+            }
+
+            list.length = 0;
+        }
+
+        return ret;
+    }
+};
+
+}
+
+#endif /* PET_HEAP_QUICKLISTHEAP_H_ */
@@ -0,0 +1,306 @@
+/*******************************************************************************
+ *
+ * Copyright (c) 2026 Tamás Seller. All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *******************************************************************************/
+
+#ifndef PET_HEAP_RELOCATABLEHEAP_H_
+#define PET_HEAP_RELOCATABLEHEAP_H_
+
+#include "heap/Heap.h"
+
+#include "platform/Compiler.h"
+
+#include <stdint.h>
+#include <stddef.h>
+
+namespace pet {
+
+/**
+ * Heap with relocatable blocks and incremental compaction.
+ *
+ * The blocks allocated from this heap are not referred to by their addresses, but
+ * through handles, that point to an entry in a table that holds the actual address.
+ * This makes it possible to move the blocks around, in order to reclaim the space
+ * lost to fragmentation, without the application being involved.
+ *
+ * The compaction is done incrementally in small steps (see _compact_), each one
+ * processing a single block: if the block before it is free, the block is moved to
+ * its start, so that the free space gets behind it and is merged with the next free
+ * block if possible. By repeating this the used blocks are slid towards the start of
+ * the heap space while the free space is coalesced at its end.
+ *
+ * Every block has a hidden prefix that refers back to the table entry, so that the
+ * entry can be updated when the block is moved.
+ *
+ * @tparam	Heap The type of the underlying heap, it is used exclusively by this object.
+ * @tparam	nHandles The number of entries in the handle table, which limits the number
+ * 			of blocks that can be allocated at the same time.
+ *
+ * @warning	The address obtained through a handle is only valid until the next
+ * 			call to _compact_.
+ */
+template<class Heap, size_t nHandles>
+class RelocatableHeap: pet::Trace<AllHeapsTrace>
+{
+    /**
+     * Entry of the handle table.
+     *
+     * Holds the address of the application data for a used entry,
+     * or the link to the next unused one.
+     */
+    union Entry
+    {
+        char* ptr;
+        Entry* next;
+    };
+
+    /// The size of the hidden prefix (that stores the back reference), keeps the alignment of the heap.
+    static constexpr uintptr_t prefixSize = (sizeof(Entry*) + Heap::alignment - 1) & ~(Heap::alignment - 1);
+
+    Heap heap;
+    void* start;
+    Entry entries[nHandles];
+    Entry* unused;
+
+    /// The next block to be examined by the compaction.
+    void* cursor;
+
+    /// Whether any block has been moved since the compaction was started from the first block.
+    bool movedInPass;
+
+    static really_inline Entry*& backReference(void* block) {
+        return *static_cast<Entry**>(block);
+    }
+
+    /**
+     * Keep the compaction cursor pointing at a block boundary.
+     *
+     * Must be called before an operation that can modify the physical
+     * block following the specified one, if the cursor is at the next
+     * block it is moved back to the specified one.
+     */
+    inline void protectCursor(void* block)
+    {
+        if(cursor == heap.nextBlock(block))
+        {
+            cursor = block;
+        }
+    }
+
+public:
+    /**
+     * Handle of a block.
+     *
+     * It is a cheap, trivially copyable identifier, a default
+     * constructed one does not refer to any block.
+     */
+    class Handle
+    {
+        friend RelocatableHeap;
+        Entry* entry = nullptr;
+        really_inline Handle(Entry* entry): entry(entry) {}
+
+    public:
+        really_inline Handle() = default;
+
+        really_inline operator bool() const {
+            return entry != nullptr;
+        }
+    };
+
+    /**
+     * Create an uninitialized heap, must be set up before use with the **init** method.
+     */
+    inline RelocatableHeap() = default;
+
+    /**
+     * Initialize the heap.
+     *
+     * @param	space The pointer to the start of the heap space.
+     * @param	size The size of the heap space.
+     */
+    inline RelocatableHeap(void* start, uintptr_t size) {
+        init(start, size);
+    }
+
+    RelocatableHeap(const RelocatableHeap&) = delete;
+
+    /** @copydoc RelocatableHeap(void*, uintptr_t) */
+    inline void init(void* start, uintptr_t size)
+    {
+        heap.init(start, size);
+        this->start = start;
+
+        unused = nullptr;
+
+        for(auto i = nHandles; i--;)
+        {
+            entries[i].next = unused;
+            unused = entries + i;
+        }
+
+        cursor = Heap::firstBlock(start);
+        movedInPass = false;
+    }
+
+    /**
+     * Allocate memory.
+     *
+     * @param	size The amount (in bytes) to be allocated.
+     * @return	The handle of the block, or an invalid one on failure.
+     */
+    inline Handle alloc(uintptr_t size)
+    {
+        if(!unused)
+        {
+            warn() << "RelocatableHeap::alloc(): Out of handles\n";
+            return {};
+        }
+
+        if(size > uintptr_t(-1) - prefixSize)
+        {
+            warn() << "RelocatableHeap::alloc(): Too large block requested\n";
+            return {};
+        }
+
+        void* block = heap.alloc(size + prefixSize);
+
+        if(!block)
+        {
+            return {};
+        }
+
+        Entry* entry = unused;
+        unused = entry->next;
+
+        backReference(block) = entry;
+        entry->ptr = static_cast<char*>(block) + prefixSize;
+        return entry;
+    }
+
+    /**
+     * Release used memory.
+     *
+     * @param	handle The handle of the block to be released.
+     */
+    inline void free(Handle handle)
+    {
+        assertThat(handle, "RelocatableHeap::free(): Invalid argument\n");
+
+        void* block = handle.entry->ptr - prefixSize;
+        void* next = heap.nextBlock(block);
+        void* merged = heap.free(block);
+
+        if(cursor == block || cursor == next)
+        {
+            cursor = merged;
+        }
+
+        handle.entry->next = unused;
+        unused = handle.entry;
+    }
+
+    /**
+     * Resize an allocation in place.
+     *
+     * @see	Heap::resize for the details.
+     */
+    inline uintptr_t resize(Handle handle, uintptr_t size)
+    {
+        assertThat(handle, "RelocatableHeap::resize(): Invalid argument\n");
+
+        void* block = handle.entry->ptr - prefixSize;
+
+        if(size > uintptr_t(-1) - prefixSize)
+        {
+            return Heap::getSize(block) - prefixSize;
+        }
+
+        protectCursor(block);
+        return heap.resize(block, size + prefixSize) - prefixSize;
+    }
+
+    /**
+     * Get the current address of the data of a block.
+     *
+     * @return	The address of the data, valid until the next call to _compact_.
+     */
+    really_inline void* get(Handle handle) const {
+        return handle.entry->ptr;
+    }
+
+    /**
+     * Do a limited number of compaction steps.
+     *
+     * Each step examines one block, moving it if possible. The time taken is proportional
+     * to the size of the moved block, so the worst case execution time of a step is bounded
+     * by the size of the largest block. When the end of the heap is reached the process is
+     * restarted from the first block.
+     *
+     * @param	nSteps The maximal number of blocks to be examined.
+     * @return	False if a full pass over the heap has been completed without moving any
+     * 			block, that is the heap is fully compacted, true otherwise.
+     */
+    inline bool compact(unsigned int nSteps)
+    {
+        while(nSteps--)
+        {
+            if(!Heap::isFree(cursor))
+            {
+                void* moved = heap.slideBack(cursor);
+
+                if(moved != cursor)
+                {
+                    Entry* entry = backReference(moved);
+                    entry->ptr = static_cast<char*>(moved) + prefixSize;
+                    movedInPass = true;
+                }
+
+                cursor = moved;
+            }
+
+            if(void* next = heap.nextBlock(cursor))
+            {
+                cursor = next;
+            }
+            else
+            {
+                cursor = Heap::firstBlock(start);
+
+                if(!movedInPass)
+                {
+                    return false;
+                }
+
+                movedInPass = false;
+            }
+        }
+
+        return true;
+    }
+
+    /**
+     * Get the usage statistics of the underlying heap (by walking the blocks).
+     */
+    inline HeapStat getStats() {
+        return heap.getStats(start);
+    }
+};
+
+}
+
+#endif /* PET_HEAP_RELOCATABLEHEAP_H_ */
@@ -0,0 +1,180 @@
+/*******************************************************************************
+ *
+ * Copyright (c) 2026 Tamás Seller. All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *******************************************************************************/
+
+#ifndef PET_HEAP_SEGREGATEDFITPOLICY_H_
+#define PET_HEAP_SEGREGATEDFITPOLICY_H_
+
+#include "heap/AvlTreePolicy.h"
+#include "data/DoubleList.h"
+#include "platform/Clz.h"
+
+namespace pet {
+
+/**
+ * Segregated exact-size bins plus a balanced tree based best-fit allocator policy.
+ *
+ * This is a dynamic memory management policy for Heap host class. Together they
+ * form a heap, that finds the exact best fitting block like the BestFitPolicy does,
+ * but without iterating over the free blocks.
+ *
+ * The small free blocks (less than _binCount_ units of the alignment) are kept in
+ * separate doubly linked lists by their exact size, and a bitmap records which ones
+ * are not empty, so the smallest suitable one is found by a single bit scan. The larger
+ * blocks are stored in a tree keyed by size and address (the same as the address-ordered
+ * AvlTreePolicy), that is searched in logarithmic time. As all the blocks in the tree are
+ * larger than any in the bins, the tree needs to be searched only if there is no suitable
+ * small block.
+ *
+ * @tparam	binCount The number of exact size bins, at most 64.
+ */
+template <class SizeType, unsigned int binCount = 64>
+class SegregatedFitPolicy: protected AvlTreePolicy<SizeType, true>
+{
+    static_assert(0 < binCount && binCount <= 64, "bin count must be between 1 and 64");
+
+    using Tree = AvlTreePolicy<SizeType, true>;
+    using Block = typename HeapBase<SizeType>::Block;
+
+    /**
+     * Header of the small free blocks.
+     */
+    class FreeBlock
+    {
+        friend pet::DoubleList<FreeBlock>;
+        FreeBlock *next, *prev;
+    };
+
+    /// The bins of the small free blocks, indexed by their size.
+    pet::DoubleList<FreeBlock> bins[binCount];
+
+    /// Non-empty bins.
+    uint64_t binMap = 0;
+
+    /// Check whether the block is stored in a bin, based on its size.
+    static really_inline bool isSmall(uintptr_t size) {
+        return size < binCount;
+    }
+
+    /// Remove a block, that has been added with the given size.
+    really_inline void removeSized(uintptr_t size, Block block)
+    {
+        if(isSmall(size))
+        {
+            bins[size].fastRemove(reinterpret_cast<FreeBlock*>(block.ptr));
+
+            if(!bins[size].front())
+            {
+                binMap &= ~(uint64_t(1) << size);
+            }
+        }
+        else
+        {
+            Tree::remove(block);
+        }
+    }
+
+protected:
+    /** @copydoc pet::TlsfPolicy::init */
+    inline void init(Block block)
+    {
+        reset();
+        add(block);
+    }
+
+    /** @copydoc pet::TlsfPolicy::reset */
+    inline void reset()
+    {
+        Tree::reset();
+
+        for(auto &bin: bins)
+        {
+            bin.clear();
+        }
+
+        binMap = 0;
+    }
+
+    /** @copydoc pet::TlsfPolicy::add */
+    inline void add(Block block)
+    {
+        const uintptr_t size = block.getSize();
+
+        if(isSmall(size))
+        {
+            bins[size].fastAddFront(reinterpret_cast<FreeBlock*>(block.ptr));
+            binMap |= uint64_t(1) << size;
+        }
+        else
+        {
+            Tree::add(block);
+        }
+    }
+
+    /** @copydoc pet::TlsfPolicy::remove */
+    really_inline void remove(Block block) {
+        removeSized(block.getSize(), block);
+    }
+
+    /** @copydoc pet::TlsfPolicy::findAndRemove */
+    inline Block findAndRemove(uintptr_t size, bool hot)
+    {
+        if(isSmall(size))
+        {
+            if(const uint64_t mask = binMap & (~uint64_t(0) << size))
+            {
+                const unsigned int idx = lsbIndex(mask);
+                FreeBlock* ret = bins[idx].front();
+                removeSized(idx, ret);
+                return ret;
+            }
+        }
+
+        return Tree::findAndRemove(size, hot);
+    }
+
+    /** @copydoc pet::TlsfPolicy::update */
+    inline void update(uintptr_t oldSize, Block block)
+    {
+        removeSized(oldSize, block);
+        add(block);
+    }
+
+    /** @copydoc pet::TlsfPolicy::longestSize */
+    inline uintptr_t longestSize()
+    {
+        if(const uintptr_t ret = Tree::longestSize())
+        {
+            return ret;
+        }
+
+        return binMap ? msbIndex(binMap) : 0;
+    }
+};
+
+/**
+ * Heap with SegregatedFitPolicy.
+ *
+ * Facade to provide nicer usage, with automatically matching redundant parameters.
+ */
+template<class SizeType, unsigned int alignmentBits, bool cheksummingOn = false, bool statsOn = false, unsigned int binCount = 64>
+using SegregatedFitHeap = Heap<SegregatedFitPolicy<SizeType, binCount>, SizeType, alignmentBits, cheksummingOn, statsOn>;
+
+}
+
+#endif /* PET_HEAP_SEGREGATEDFITPOLICY_H_ */
@@ -0,0 +1,273 @@
+/*******************************************************************************
+ *
+ * Copyright (c) 2026 Tamás Seller. All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *******************************************************************************/
+
+#ifndef PET_HEAP_SHARDEDHEAP_H_
+#define PET_HEAP_SHARDEDHEAP_H_
+
+#include "heap/Heap.h"
+
+#include "platform/Atomic.h"
+#include "platform/Compiler.h"
+
+#include <stdint.h>
+
+namespace pet {
+
+/**
+ * Arena selector that assigns each thread to an arena in a round-robin fashion.
+ *
+ * The assignment is done on the first use in a thread, and kept for its lifetime.
+ */
+struct ThreadArenaSelector
+{
+    static inline unsigned int current()
+    {
+        static pet::Atomic<unsigned int> counter;
+        static thread_local unsigned int slot = counter.increment();
+        return slot;
+    }
+};
+
+/**
+ * Set of independent heaps (arenas), that the allocations are spread over.
+ *
+ * A single heap shared by many threads is a contention point even with a good lock, the
+ * cache lines of the lock and the free store keep moving between the CPUs. This class
+ * splits the heap space into equal slices, each managed by a separate heap with its own
+ * lock, and serves the allocations from the arena that belongs to the current CPU or thread
+ * (as told by the _Selector_), so the threads running on different CPUs mostly use different
+ * arenas. If the selected arena can not serve a request the others are tried in turn.
+ *
+ * The blocks can be released from any thread, the owning arena is found from the address
+ * of the block (as the slices are contiguous), so no extra header is needed.
+ *
+ * @tparam	Heap The type of the arenas.
+ * @tparam	Mutex The type of the lock of the arenas, it has to provide the _lock_
+ * 			and _unlock_ methods (like std::mutex does).
+ * @tparam	nArenas The number of arenas.
+ * @tparam	Selector Provides the static _current()_ method, that returns an index (taken
+ * 			modulo the number of arenas) for the caller, like the number of the CPU it runs on
+ * 			(see the CurrentCpuSelector for Linux) or the ThreadArenaSelector.
+ */
+template<class Heap, class Mutex, unsigned int nArenas, class Selector = ThreadArenaSelector>
+class ShardedHeap: pet::Trace<AllHeapsTrace>
+{
+    static_assert(nArenas > 0, "there must be at least one arena");
+
+    /**
+     * A heap and its lock, on separate cache lines from the others.
+     */
+    struct alignas(64) Arena
+    {
+        Mutex mutex;
+        Heap heap;
+    };
+
+    /**
+     * Holds the lock of an arena.
+     */
+    class Lock
+    {
+        Mutex &mutex;
+
+    public:
+        really_inline Lock(Arena &arena): mutex(arena.mutex) { mutex.lock(); }
+        really_inline ~Lock() { mutex.unlock(); }
+        Lock(const Lock&) = delete;
+    };
+
+    Arena arenas[nArenas];
+    char* start = nullptr;
+    uintptr_t sliceSize = 0;
+
+    /// Find the arena that the block belongs to.
+    really_inline Arena& arenaOf(void* ptr)
+    {
+        const uintptr_t idx = (static_cast<char*>(ptr) - start) / sliceSize;
+        assertThat(static_cast<char*>(ptr) >= start && idx < nArenas, "ShardedHeap: Block does not belong to the heap");
+        return arenas[idx];
+    }
+
+    /// Allocate from the arenas, starting with the selected one.
+    inline void* allocFrom(unsigned int first, uintptr_t size, bool hot)
+    {
+        for(unsigned int i = 0; i < nArenas; i++)
+        {
+            Arena &arena = arenas[(first + i) % nArenas];
+            Lock lock(arena);
+
+            if(void* ret = arena.heap.alloc(size, hot))
+            {
+                return ret;
+            }
+        }
+
+        return nullptr;
+    }
+
+public:
+    /**
+     * Create an uninitialized heap, that needs to be initialized before use.
+     */
+    inline ShardedHeap() = default;
+
+    ShardedHeap(const ShardedHeap&) = delete;
+
+    /**
+     * Initialize the arenas on equal slices of the given area.
+     *
+     * @param	start The start of the area.
+     * @param	size The size of the area, each arena gets _size / nArenas_ of it.
+     */
+    inline void init(void* start, uintptr_t size)
+    {
+        this->start = static_cast<char*>(start);
+        sliceSize = size / nArenas;
+
+        for(unsigned int i = 0; i < nArenas; i++)
+        {
+            arenas[i].heap.init(this->start + i * sliceSize, sliceSize);
+        }
+    }
+
+    /**
+     * Allocate memory from the arena of the caller (or another one if that is exhausted).
+     *
+     * @see	Heap::alloc for the details.
+     */
+    inline void* alloc(uintptr_t size, bool hot = false) {
+        return allocFrom(Selector::current() % nArenas, size, hot);
+    }
+
+    /**
+     * Release memory, allocated from any of the arenas.
+     *
+     * @see	Heap::free for the details.
+     */
+    inline void free(void* ptr)
+    {
+        Arena &arena = arenaOf(ptr);
+        Lock lock(arena);
+        arena.heap.free(ptr);
+    }
+
+    /**
+     * Resize an allocation in place.
+     *
+     * @see	Heap::resize for the details.
+     */
+    inline uintptr_t resize(void* ptr, uintptr_t size)
+    {
+        Arena &arena = arenaOf(ptr);
+        Lock lock(arena);
+        return arena.heap.resize(ptr, size);
+    }
+
+    /**
+     * Resize an allocation, moving the data (possibly to another arena) if needed.
+     *
+     * @see	Heap::reallocate for the details.
+     */
+    inline void* reallocate(void* ptr, uintptr_t size)
+    {
+        if(!ptr)
+        {
+            return alloc(size);
+        }
+
+        Arena &arena = arenaOf(ptr);
+
+        {
+            Lock lock(arena);
+
+            if(void* ret = arena.heap.reallocate(ptr, size))
+            {
+                return ret;
+            }
+        }
+
+        void* ret = allocFrom(unsigned(&arena - arenas) + 1, size, false);
+
+        if(ret)
+        {
+            const uintptr_t oldSize = Heap::getSize(ptr);
+            auto d = static_cast<char*>(ret);
+            auto s = static_cast<const char*>(ptr);
+
+            for(auto n = oldSize < size ? oldSize : size; n--;)
+            {
+                *d++ = *s++;
+            }
+
+            free(ptr);
+        }
+
+        return ret;
+    }
+
+    /**
+     * Get usable size of an allocation.
+     *
+     * @see	Heap::getSize for the details.
+     */
+    static inline uintptr_t getSize(void* ptr) {
+        return Heap::getSize(ptr);
+    }
+
+    /**
+     * Allocate memory for an object of type T.
+     */
+    template<class T>
+    inline void* allocFor()
+    {
+        static_assert(alignof(T) <= Heap::alignment, "Object requires larger alignment than that of the heap");
+        return alloc(sizeof(T));
+    }
+
+    /**
+     * Get the usage statistics of all arenas together (by walking the blocks).
+     *
+     * The longest free block is that of the arena that has the longest one.
+     */
+    inline HeapStat getStats()
+    {
+        HeapStat ret{0, 0, 0, 0};
+
+        for(unsigned int i = 0; i < nArenas; i++)
+        {
+            Lock lock(arenas[i]);
+            const HeapStat s = arenas[i].heap.getStats(start + i * sliceSize);
+
+            if(ret.longestFree < s.longestFree)
+            {
+                ret.longestFree = s.longestFree;
+            }
+
+            ret.totalFree += s.totalFree;
+            ret.nUsed += s.nUsed;
+            ret.totalUsed += s.totalUsed;
+        }
+
+        return ret;
+    }
+};
+
+}
+
+#endif /* PET_HEAP_SHARDEDHEAP_H_ */
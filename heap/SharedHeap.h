@@ -0,0 +1,311 @@
+/*******************************************************************************
+ *
+ * Copyright (c) 2026 Tamás Seller. All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *******************************************************************************/
+
+#ifndef PET_HEAP_SHAREDHEAP_H_
+#define PET_HEAP_SHAREDHEAP_H_
+
+#include "heap/Heap.h"
+
+#include "managed/OffsetPtr.h"
+#include "meta/Resettable.h"
+
+#include "platform/Compiler.h"
+
+#include <atomic>
+
+#include <stdint.h>
+
+namespace pet {
+
+/**
+ * Heap in shared memory, that can be used by multiple processes at the same time.
+ *
+ * The whole state of the heap (the heap object, a lock and a root pointer) is stored at
+ * the start of the shared area, followed by the heap space. The processes may map the area
+ * at different addresses, so the heap needs to be position independent (@see Heap::rebase),
+ * which is the case for the BestFitPolicy with relative links. The operations take the lock,
+ * so the blocks can be allocated by one process and released by another one.
+ *
+ * The blocks can be passed between the processes without copying: either via the position
+ * independent containers (OffsetAtomicList, OffsetFifo) placed in the shared heap, or as
+ * plain offsets (@see offsetOf and atOffset) sent over any other channel.
+ *
+ * @tparam	Heap The type of the heap, it must have a position independent policy.
+ * If a process dies in the middle of an operation the heap may be left inconsistent. When
+ * the lock reports this (like the robust ProcessSharedMutex does via _takeAbandoned_) the
+ * next operation verifies the blocks and rebuilds the free store (@see Heap::attach), and
+ * if the blocks themselves are found corrupted, the heap refuses all further operations
+ * (@see isBroken).
+ *
+ * @tparam	Mutex The lock type, that must work across processes when placed in shared
+ * 			memory (like the ProcessSharedMutex on Linux).
+ */
+template<class Heap, class Mutex>
+class SharedHeap: pet::Trace<AllHeapsTrace>
+{
+    /**
+     * The shared state, at the start of the area.
+     */
+    struct Header
+    {
+        static constexpr uint32_t magicValue = 0x50455453; // 'PETS'
+
+        volatile uint32_t magic;
+        uint32_t alignment;
+        volatile uint32_t broken;
+        uint64_t size;
+        Mutex mutex;
+        OffsetPtr<void> root;
+        Heap heap;
+    };
+
+    /// The size of the header, keeps the alignment of the heap.
+    static constexpr uintptr_t headerSize = (sizeof(Header) + Heap::alignment - 1) & ~(Heap::alignment - 1);
+
+    Header* header = nullptr;
+
+    /**
+     * Holds the lock and adjusts the heap to the local mapping for the duration of an operation.
+     */
+    class Access: pet::Trace<AllHeapsTrace>
+    {
+        Header* header;
+
+        /// Check whether the holder of the lock died, for the locks that can tell.
+        template<class M>
+        static really_inline auto abandoned(M& mutex, int) -> decltype(mutex.takeAbandoned()) {
+            return mutex.takeAbandoned();
+        }
+
+        /// Other locks can not be abandoned.
+        template<class M>
+        static really_inline bool abandoned(M&, long) {
+            return false;
+        }
+
+    public:
+        really_inline Access(Header* header): header(header)
+        {
+            header->mutex.lock();
+
+            const auto space = reinterpret_cast<char*>(header) + headerSize;
+            const auto size = header->size - headerSize;
+
+            if(abandoned(header->mutex, 0))
+            {
+                warn() << "SharedHeap: Lock abandoned by a dead process, verifying heap\n";
+
+                if(!header->heap.attach(space, size))
+                {
+                    warn() << "SharedHeap: Inconsistent heap, refusing further operations\n";
+                    header->broken = 1;
+                }
+            }
+            else
+            {
+                header->heap.rebase(space, size);
+            }
+        }
+
+        really_inline ~Access() {
+            header->mutex.unlock();
+        }
+
+        /// Check whether the heap can be used.
+        really_inline explicit operator bool() const {
+            return !header->broken;
+        }
+
+        Access(const Access&) = delete;
+    };
+
+public:
+    /**
+     * Create a detached object, that needs to be set up by _create_ or _open_ before use.
+     */
+    inline SharedHeap() = default;
+
+    SharedHeap(const SharedHeap&) = delete;
+
+    /**
+     * Initialize a new heap in the shared area.
+     *
+     * Must be called by one process, before the others _open_ the same area.
+     *
+     * @param	area The start of the area (aligned to the alignment of the heap).
+     * @param	size The size of the area.
+     */
+    inline void create(void* area, uintptr_t size)
+    {
+        assertThat(headerSize < size, "SharedHeap::create(): Area too small\n");
+        assertThat(!(reinterpret_cast<uintptr_t>(area) & (Heap::alignment - 1)), "SharedHeap::create(): Misaligned area\n");
+
+        header = static_cast<Header*>(area);
+        header->magic = 0;
+        header->alignment = Heap::alignment;
+        header->broken = 0;
+        header->size = size;
+        new(&header->mutex, NewOperatorDisambiguator()) Mutex();
+        header->root = nullptr;
+        new(&header->heap, NewOperatorDisambiguator()) Heap();
+        header->heap.init(reinterpret_cast<char*>(area) + headerSize, size - headerSize);
+
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        header->magic = Header::magicValue;
+    }
+
+    /**
+     * Use a heap created earlier (possibly by another process) in the shared area.
+     *
+     * @param	area The start of the area, as mapped by the caller.
+     * @param	size The size of the area, the same as on creation.
+     * @return	True on success, false if the area does not contain a heap (yet) or it is incompatible.
+     */
+    inline bool open(void* area, uintptr_t size)
+    {
+        auto h = static_cast<Header*>(area);
+
+        if(h->magic != Header::magicValue || h->alignment != Heap::alignment || h->size != size)
+        {
+            warn() << "SharedHeap::open(): No compatible heap found\n";
+            return false;
+        }
+
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        header = h;
+        return true;
+    }
+
+    /**
+     * Check whether the heap has been found corrupted after the death of a process.
+     *
+     * In that case all allocations fail and releases are ignored.
+     */
+    inline bool isBroken() const
+    {
+        Access a(header);
+        return !a;
+    }
+
+    /**
+     * Get the root object.
+     *
+     * @return	The object set by _setRoot_, or NULL if it has not been set.
+     */
+    template<class T = void>
+    really_inline T* getRoot() const
+    {
+        Access a(header);
+        return static_cast<T*>(header->root.get());
+    }
+
+    /**
+     * Set the root object, through which the other processes can find the shared data.
+     *
+     * @param	root An object allocated from this heap, or NULL.
+     */
+    really_inline void setRoot(void* root)
+    {
+        Access a(header);
+        header->root = root;
+    }
+
+    /**
+     * Get the position of a block in the shared area, that is the same for all processes.
+     */
+    really_inline uintptr_t offsetOf(void* ptr) const {
+        return static_cast<char*>(ptr) - reinterpret_cast<char*>(header);
+    }
+
+    /**
+     * Get the local address of a block from its position (@see offsetOf).
+     */
+    template<class T = void>
+    really_inline T* atOffset(uintptr_t offset) const {
+        return reinterpret_cast<T*>(reinterpret_cast<char*>(header) + offset);
+    }
+
+    /** @copydoc Heap::alloc */
+    inline void* alloc(uintptr_t size, bool hot = false)
+    {
+        Access a(header);
+        return a ? header->heap.alloc(size, hot) : nullptr;
+    }
+
+    /**
+     * Release memory, allocated by any of the processes.
+     *
+     * @see	Heap::free for the details.
+     */
+    inline void free(void* ptr)
+    {
+        Access a(header);
+
+        if(a)
+        {
+            header->heap.free(ptr);
+        }
+    }
+
+    /** @copydoc Heap::resize */
+    inline uintptr_t resize(void* ptr, uintptr_t size)
+    {
+        Access a(header);
+        return a ? header->heap.resize(ptr, size) : 0;
+    }
+
+    /** @copydoc Heap::reallocate */
+    inline void* reallocate(void* ptr, uintptr_t size)
+    {
+        Access a(header);
+        return a ? header->heap.reallocate(ptr, size) : nullptr;
+    }
+
+    /**
+     * Get usable size of an allocation.
+     *
+     * @see	Heap::getSize for the details.
+     */
+    static inline uintptr_t getSize(void* ptr) {
+        return Heap::getSize(ptr);
+    }
+
+    /**
+     * Get the usage statistics of the heap (by walking the blocks).
+     */
+    inline HeapStat getStats()
+    {
+        Access a(header);
+        return a ? header->heap.getStats(reinterpret_cast<char*>(header) + headerSize) : HeapStat{};
+    }
+
+    /**
+     * Allocate memory for an object of type T.
+     */
+    template<class T>
+    inline void* allocFor()
+    {
+        static_assert(alignof(T) <= Heap::alignment, "Object requires larger alignment than that of the heap");
+        return alloc(sizeof(T));
+    }
+};
+
+}
+
+#endif /* PET_HEAP_SHAREDHEAP_H_ */
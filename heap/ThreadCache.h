@@ -0,0 +1,283 @@
+/*******************************************************************************
+ *
+ * Copyright (c) 2026 Tamás Seller. All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *******************************************************************************/
+
+#ifndef PET_HEAP_THREADCACHE_H_
+#define PET_HEAP_THREADCACHE_H_
+
+#include "heap/HeapBase.h"
+
+#include "platform/Compiler.h"
+
+#include <stdint.h>
+
+namespace pet {
+
+/**
+ * Thread-caching front-end for a shared heap.
+ *
+ * The Heap itself is not protected against concurrent access, so if it is shared
+ * between threads, every operation has to be done while holding a lock. This class
+ * reduces the number of times the lock needs to be taken by keeping a small stash
+ * (a magazine) of blocks per size class, that can be handed out and taken back without
+ * touching the shared heap at all.
+ *
+ * An instance of this class is meant to be used by a single thread only (typically
+ * it is a _thread_local_ object or lives on the stack of the thread function), while
+ * several such instances can refer to the same heap and lock. The magazines are refilled
+ * and flushed in batches, that is half of the capacity is transferred in one go while
+ * holding the lock, so the cost of locking is amortized over several operations.
+ *
+ * Blocks are sorted into size classes according to their usable size, with a fixed
+ * granularity. Requests that are larger than what the largest class can accommodate
+ * are forwarded to the heap directly (with locking). Blocks can be freed through any
+ * instance, not only the one that has allocated it.
+ *
+ * @tparam	Heap The type of the shared heap instance. If it has the _allocBatch_ and
+ * 			_freeBatch_ methods (like the Heap does), the magazines are transferred
+ * 			through those, otherwise block by block.
+ * @tparam	Mutex The type of the lock that guards the shared heap, it has to provide
+ * 			the _lock_ and _unlock_ methods (like std::mutex does).
+ * @tparam	granularity The difference between the block sizes of neighboring size
+ * 			classes, in bytes.
+ * @tparam	nClasses The number of size classes.
+ * @tparam	magazineSize The maximal number of blocks cached per size class.
+ *
+ * @note	The cached blocks are counted as used by the heap, so this technique
+ * 			trades some memory for the lower contention.
+ */
+template<class Heap, class Mutex, uintptr_t granularity = 16, unsigned int nClasses = 16, unsigned int magazineSize = 32>
+class ThreadCache: pet::Trace<AllHeapsTrace>
+{
+    static_assert(granularity && !(granularity & (granularity - 1)), "granularity must be a power of two");
+    static_assert(magazineSize >= 2, "magazine must be able to hold at least two blocks");
+
+    /**
+     * Cached blocks of a size class.
+     *
+     * Works as a LIFO, so that the most recently freed
+     * (possibly cache-hot) blocks are reused first.
+     */
+    struct Magazine
+    {
+        unsigned int count = 0;
+        void* blocks[magazineSize];
+    };
+
+    Heap &heap;
+    Mutex &mutex;
+    Magazine magazines[nClasses];
+
+    /// Size class for allocation request, rounds up.
+    static really_inline uintptr_t requestClass(uintptr_t size) {
+        return (size + granularity - 1) / granularity - 1;
+    }
+
+    /// Size class for an existing block, rounds down.
+    static really_inline uintptr_t blockClass(uintptr_t size) {
+        return size / granularity - 1;
+    }
+
+    /// The size of the blocks requested from the heap for a class.
+    static really_inline uintptr_t classSize(uintptr_t idx) {
+        return (idx + 1) * granularity;
+    }
+
+    /// Allocate blocks in one batch, for heaps that support it.
+    template<class H = Heap>
+    static inline auto allocBlocks(H &heap, uintptr_t size, unsigned int n, void** out, int)
+        -> decltype(heap.allocBatch(size, n, out))
+    {
+        return heap.allocBatch(size, n, out);
+    }
+
+    /// Allocate blocks one by one, for the other heaps.
+    template<class H = Heap>
+    static inline unsigned int allocBlocks(H &heap, uintptr_t size, unsigned int n, void** out, long)
+    {
+        unsigned int ret = 0;
+
+        while(ret < n)
+        {
+            if(void* ptr = heap.alloc(size))
+            {
+                out[ret++] = ptr;
+            }
+            else
+            {
+                break;
+            }
+        }
+
+        return ret;
+    }
+
+    /// Release blocks in one batch, for heaps that support it.
+    template<class H = Heap>
+    static inline auto freeBlocks(H &heap, void** ptrs, unsigned int n, int)
+        -> decltype(heap.freeBatch(ptrs, n))
+    {
+        heap.freeBatch(ptrs, n);
+    }
+
+    /// Release blocks one by one, for the other heaps.
+    template<class H = Heap>
+    static inline void freeBlocks(H &heap, void** ptrs, unsigned int n, long)
+    {
+        for(unsigned int i = 0; i < n; i++)
+        {
+            heap.free(ptrs[i]);
+        }
+    }
+
+    /// Fetch half a magazine worth of blocks from the heap.
+    inline void refill(unsigned int idx)
+    {
+        Magazine &m = magazines[idx];
+
+        mutex.lock();
+        m.count += allocBlocks(heap, classSize(idx), magazineSize / 2 - m.count, m.blocks + m.count, 0);
+        mutex.unlock();
+    }
+
+    /// Return the older half of the cached blocks to the heap.
+    inline void drain(unsigned int idx)
+    {
+        Magazine &m = magazines[idx];
+        const unsigned int n = magazineSize / 2;
+
+        mutex.lock();
+        freeBlocks(heap, m.blocks, n, 0);
+        mutex.unlock();
+
+        for(unsigned int i = n; i < m.count; i++)
+        {
+            m.blocks[i - n] = m.blocks[i];
+        }
+
+        m.count -= n;
+    }
+
+public:
+    /**
+     * Create a cache in front of a shared heap.
+     *
+     * @param	heap The shared heap instance.
+     * @param	mutex The lock that protects the shared heap.
+     */
+    inline ThreadCache(Heap &heap, Mutex &mutex): heap(heap), mutex(mutex) {}
+
+    ThreadCache(const ThreadCache&) = delete;
+
+    /**
+     * Release all cached blocks.
+     */
+    inline ~ThreadCache() {
+        flush();
+    }
+
+    /**
+     * Allocate memory.
+     *
+     * Serves the request from the cache if possible, refilling it from the heap if needed.
+     *
+     * @param	size The amount (in bytes) to be allocated.
+     * @return	A pointer to the start of the allocated region or NULL on failure.
+     */
+    inline void* alloc(uintptr_t size)
+    {
+        const auto idx = requestClass(size ? size : 1);
+
+        if(idx < nClasses)
+        {
+            Magazine &m = magazines[idx];
+
+            if(!m.count)
+            {
+                refill(idx);
+            }
+
+            if(m.count)
+            {
+                return m.blocks[--m.count];
+            }
+
+            return nullptr;
+        }
+
+        mutex.lock();
+        void* ret = heap.alloc(size);
+        mutex.unlock();
+        return ret;
+    }
+
+    /**
+     * Release used memory.
+     *
+     * Stashes the block into the cache if it belongs to any of the size
+     * classes, otherwise it is placed back into the shared heap right away.
+     *
+     * @param	ptr The pointer to the block that is to be freed.
+     */
+    inline void free(void* ptr)
+    {
+        assertThat(ptr, "ThreadCache::free(): Invalid argument\n");
+
+        const auto size = heap.getSize(ptr);
+
+        if(size < granularity || nClasses <= blockClass(size))
+        {
+            mutex.lock();
+            heap.free(ptr);
+            mutex.unlock();
+            return;
+        }
+
+        const auto idx = blockClass(size);
+        Magazine &m = magazines[idx];
+
+        if(m.count == magazineSize)
+        {
+            drain(idx);
+        }
+
+        m.blocks[m.count++] = ptr;
+    }
+
+    /**
+     * Release all cached blocks.
+     *
+     * Places back all the cached blocks into the shared heap, in a single locked session.
+     */
+    inline void flush()
+    {
+        mutex.lock();
+
+        for(auto &m: magazines)
+        {
+            freeBlocks(heap, m.blocks, m.count, 0);
+            m.count = 0;
+        }
+
+        mutex.unlock();
+    }
+};
+
+}
+
+#endif /* PET_HEAP_THREADCACHE_H_ */
@@ -23,11 +23,19 @@
 #include "heap/Heap.h"
 #include "data/DoubleList.h"
 #include "meta/Resettable.h"
+#include "platform/Clz.h"
 
 class TlsfPolicyInternalsTest;
 
 namespace pet {
 
+namespace detail {
+    template<unsigned int nBits, unsigned int = (nBits > 16) + (nBits > 32)> struct TlsfBitmap;
+    template<unsigned int nBits> struct TlsfBitmap<nBits, 0> { using Type = uint16_t; };
+    template<unsigned int nBits> struct TlsfBitmap<nBits, 1> { using Type = uint32_t; };
+    template<unsigned int nBits> struct TlsfBitmap<nBits, 2> { using Type = uint64_t; };
+}
+
 /**
  * Two-level segregated fit allocator policy.
  *
@@ -46,8 +54,8 @@ namespace pet {
  * that have a size greater or equal to requested one. It is always the first
  * block that is removed from that list.
  *
- * It can be seen that for the first few (32 for this implementation) slots
- * this scheme is optimally accurate, for bigger sizes the precision
+ * It can be seen that for the first few (twice the number of second level
+ * buckets) slots this scheme is optimally accurate, for bigger sizes the precision
  * logarithmically decreases. As the blocks that are too small to be split
  * are served optimally there is no waste introduced by this technique.
  * Larger sized blocks can be split so the leftover space can be reused.
@@ -60,11 +68,27 @@ namespace pet {
  * entry from this data structure, so to be able to that in constant time the
  * lists of the buckets need to be linked in both directions.
  *
+ * The number of first level (logarithmic) and second level (linear) buckets can be
+ * configured: the former determines the largest block that can be handled, which
+ * is (2 ^ (flCount + log2(slCount) - 1)) units of the alignment of the heap, the latter
+ * is the number of subdivisions of each power-of-two range. More subdivisions give
+ * more accurate fits (less fragmentation) at the cost of more static storage and
+ * possibly wider bitmaps. The bitmaps are 16, 32 or 64 bits wide depending on the
+ * counts, the searches are done with single bit scan instructions in every case.
+ *
  * @see http://www.gii.upv.es/tlsf/files/ecrts04_tlsf.pdf for the original papaer.
+ *
+ * @tparam	flCount The number of first level buckets, at most 64.
+ * @tparam	slCount The number of second level buckets, a power of two and at most 64.
  */
-template <class SizeType>
+template <class SizeType, unsigned int flCount = 16, unsigned int slCount = 16>
 class TlsfPolicy: private HeapBase<SizeType>
 {
+    static_assert(0 < flCount && flCount <= 64, "first level count must be between 1 and 64");
+    static_assert(1 < slCount && slCount <= 64 && !(slCount & (slCount - 1)), "second level count must be a power of two between 2 and 64");
+
+    static constexpr unsigned int slBits = ilog2(slCount);
+
     friend ::TlsfPolicyInternalsTest;
 
     /** The Block of HeapBase is used here as the common representation with the Heap host */
@@ -127,6 +151,28 @@ class TlsfPolicy: private HeapBase<SizeType>
         really_inline bool isEmpty() {
             return !this->iterator().current();
         }
+
+        /**
+         * Largest element.
+         *
+         * Finds the size of the largest block in the list, by iterating over all of them.
+         *
+         * @return	The size of the largest block (zero if empty).
+         */
+        inline uintptr_t longestSize()
+        {
+            uintptr_t ret = 0;
+
+            for(auto it = this->iterator(); it.current(); it.step())
+            {
+                const uintptr_t size = Block(it.current()).getSize();
+
+                if(ret < size)
+                    ret = size;
+            }
+
+            return ret;
+        }
     };
 
     /**
@@ -148,25 +194,17 @@ class TlsfPolicy: private HeapBase<SizeType>
      */
     class Index: Resettable<Index>
     {
-        unsigned short flMap = 0;
-        unsigned short slMap[16] = {0,};
-        FreeList blocks[256];
+        using FlMap = typename detail::TlsfBitmap<flCount>::Type;
+        using SlMap = typename detail::TlsfBitmap<slCount>::Type;
 
-        static inline unsigned int getLogMap(unsigned int size)
-        {
-            if(!size)
-            {
-                return 0;
-            }
+        FlMap flMap = 0;
+        SlMap slMap[flCount] = {0,};
+        FreeList blocks[flCount * slCount];
 
-            if(unsigned int lz = __builtin_clz(size); lz > 28)
-            {
-                return 0;
-            }
-            else
-            {
-                return 28-lz;
-            }
+        /// A bitmap with the bits of (and above) the specified index set.
+        template<class Map>
+        static really_inline Map bitsFrom(unsigned int idx) {
+            return (idx < sizeof(Map) * 8) ? Map(Map(~Map(0)) << idx) : Map(0);
         }
 
         friend class Index::Resettable;
@@ -174,6 +212,23 @@ class TlsfPolicy: private HeapBase<SizeType>
     public:
         using Index::Resettable::reset;
 
+        /**
+         * First level index for size.
+         *
+         * The sizes below the number of second level buckets are all mapped to the
+         * first one, above that it is the position of the highest bit, offset so that
+         * the linear and logarithmic ranges are contiguous.
+         */
+        static inline unsigned int getLogMap(uintptr_t size)
+        {
+            if(size < slCount)
+            {
+                return 0;
+            }
+
+            return msbIndex(size) - slBits + 1;
+        }
+
         /**
          * Hash value.
          *
@@ -219,8 +274,8 @@ class TlsfPolicy: private HeapBase<SizeType>
          */
         inline void setBits(const Entry& index)
         {
-            flMap |= 1 << index.fl;
-            slMap[index.fl] |= 1 << index.sl;
+            flMap |= FlMap(1) << index.fl;
+            slMap[index.fl] |= SlMap(1) << index.sl;
         }
 
         /**
@@ -232,11 +287,11 @@ class TlsfPolicy: private HeapBase<SizeType>
          */
         inline void resetBits(const Entry& index)
         {
-            slMap[index.fl] &= ~(1 << index.sl);
+            slMap[index.fl] &= SlMap(~(SlMap(1) << index.sl));
 
             if(!slMap[index.fl])
             {
-                flMap &= ~(1 << index.fl);
+                flMap &= FlMap(~(FlMap(1) << index.fl));
             }
         }
 
@@ -250,8 +305,8 @@ class TlsfPolicy: private HeapBase<SizeType>
          */
         inline FreeList& getListFor(const Entry &index)
         {
-            AllHeapsTrace::assertThat(index.sl < 16 && index.fl < 16);
-            return blocks[index.sl + index.fl*16];
+            AllHeapsTrace::assertThat(index.sl < slCount && index.fl < flCount);
+            return blocks[index.sl + index.fl * slCount];
         }
 
         /**
@@ -262,7 +317,7 @@ class TlsfPolicy: private HeapBase<SizeType>
          * @param	size The size for wich the hash is to be calculated.
          * @return	The generated hash.
          */
-        static inline Entry getInsertionEntry(unsigned int size)
+        static inline Entry getInsertionEntry(uintptr_t size)
         {
             Entry ret;
 
@@ -273,7 +328,7 @@ class TlsfPolicy: private HeapBase<SizeType>
                 size >>= ret.fl - 1;
             }
 
-            ret.sl = size & 0xf;
+            ret.sl = size & (slCount - 1);
 
             return ret;
         }
@@ -286,45 +341,66 @@ class TlsfPolicy: private HeapBase<SizeType>
          *
          * @return	The bucket identifier for the list or an invalid one if none found.
          */
-        inline Entry getGreaterEqualEntry(unsigned int size)
+        inline Entry getGreaterEqualEntry(uintptr_t size)
         {
-            int logMap = getLogMap(size);
+            unsigned int logMap = getLogMap(size);
 
             if(logMap > 1)  // round up
             {
-                size += (1 << (logMap - 1)) - 1;
+                size += (uintptr_t(1) << (logMap - 1)) - 1;
             }
 
             Entry entry = getInsertionEntry(size);
 
-            unsigned int newMask = slMap[entry.fl] & ~((1 << (entry.sl))-1);
-            if(newMask)
+            if(entry.fl < flCount)
             {
-                entry.sl = __builtin_ctz(newMask);
-            }
-            else
-            {
-                newMask = flMap & ~((1 << (entry.fl+1))-1);
-
-                if(!newMask)
+                if(const SlMap newMask = slMap[entry.fl] & bitsFrom<SlMap>(entry.sl))
                 {
-                    entry.sl = entry.fl = ((unsigned short)-1u);
+                    entry.sl = lsbIndex(newMask);
+                    return entry;
                 }
-                else
+
+                if(const FlMap newMask = flMap & bitsFrom<FlMap>(entry.fl + 1))
                 {
-                    entry.fl = __builtin_ctz(newMask);
-                    entry.sl = __builtin_ctz(slMap[entry.fl]);
+                    entry.fl = lsbIndex(newMask);
+                    entry.sl = lsbIndex(slMap[entry.fl]);
+                    return entry;
                 }
             }
 
+            entry.sl = entry.fl = ((unsigned short)-1u);
             return entry;
         }
 
+        /**
+         * Get the highest non-empty bucket.
+         *
+         * @return	The bucket identifier for the list of the largest blocks or an invalid one if none found.
+         */
+        inline Entry getHighestEntry()
+        {
+            Entry entry;
+
+            if(!flMap)
+            {
+                entry.sl = entry.fl = ((unsigned short)-1u);
+            }
+            else
+            {
+                entry.fl = msbIndex(flMap);
+                entry.sl = msbIndex(slMap[entry.fl]);
+            }
+
+            return entry;
+        }
     };
 
     /** Free block database instance */
     Index index;
 
+    /** Size of the longest free block, for the statistics */
+    typename HeapBase<SizeType>::LongestFree longest;
+
 protected:
     /**
      * Minimal required block size.
@@ -346,17 +422,30 @@ protected:
      */
     inline void add(Block b)
     {
-        const unsigned int size = b.getSize();
+        const uintptr_t size = b.getSize();
         FreeBlock *block = (FreeBlock *)b.ptr;
 
         typename Index::Entry insEntry = Index::getInsertionEntry(size);
         index.getListFor(insEntry).add(block);
         index.setBits(insEntry);
+        longest.added(size);
     }
 
-    inline void init(Block block)
+    /**
+     * Empty the free store.
+     *
+     * Used before rebuilding the free store from the blocks of an existing heap space.
+     */
+    inline void reset()
     {
         index.reset();
+        longest.set(0);
+    }
+
+    inline void init(Block block)
+    {
+        AllHeapsTrace::assertThat(Index::getLogMap(block.getSize()) < flCount, "Heap too big for the TLSF index (flCount is too low)");
+        reset();
         add(block);
     }
 
@@ -371,7 +460,7 @@ protected:
      */
     inline void remove(Block b)
     {
-        const unsigned int size = b.getSize();
+        const uintptr_t size = b.getSize();
         FreeBlock *block = (FreeBlock *)b.ptr;
 
         typename Index::Entry remEntry = Index::getInsertionEntry(size);
@@ -382,6 +471,8 @@ protected:
         {
             index.resetBits(remEntry);
         }
+
+        longest.removed(size);
     }
 
     /**
@@ -394,9 +485,9 @@ protected:
      * @param 	block The block whose size is to be updated.
      * @param	oldSize The size prior to the update.
      */
-    inline void update(unsigned int oldSize, Block b)
+    inline void update(uintptr_t oldSize, Block b)
     {
-        const unsigned int size = b.getSize();
+        const uintptr_t size = b.getSize();
         FreeBlock *block = (FreeBlock *)b.ptr;
 
         typename Index::Entry oldEntry = Index::getInsertionEntry(oldSize);
@@ -413,6 +504,8 @@ protected:
             index.getListFor(insEntry).add(block);
             index.setBits(insEntry);
         }
+
+        longest.changed(oldSize, size);
     }
 
     /**
@@ -425,7 +518,7 @@ protected:
      * @param 	size The size of the block to be found.
      * @return	The block or NULL if none found.
      */
-    inline Block findAndRemove(unsigned int size, bool hot)
+    inline Block findAndRemove(uintptr_t size, bool hot)
     {
         typename Index::Entry findEntry = index.getGreaterEqualEntry(size);
 
@@ -443,9 +536,31 @@ protected:
             index.resetBits(findEntry);
         }
 
+        longest.removed(ret.getSize());
         return ret;
     }
 
+    /**
+     * Longest free block.
+     *
+     * Returns the cached size in constant time. The highest non-empty bucket is only looked
+     * through if the cached block has been taken out since the last query (without a larger
+     * one added since).
+     *
+     * @note This method is part of the optional statistics interface of the Heap host.
+     *
+     * @return	The size of the largest free block or zero if there is none.
+     */
+    inline uintptr_t longestSize()
+    {
+        if(!longest.isKnown())
+        {
+            typename Index::Entry entry = index.getHighestEntry();
+            longest.set(entry.isValid() ? 0 : index.getListFor(entry).longestSize());
+        }
+
+        return longest.get();
+    }
 };
 
 /**
@@ -453,8 +568,8 @@ protected:
  *
  * Facade to provide nicer usage, with automatically matching redundant parameters.
  */
-template<class SizeType, unsigned int alignmentBits, bool cheksummingOn = false>
-using TlsfHeap = Heap<TlsfPolicy<SizeType>, SizeType, alignmentBits, cheksummingOn>;
+template<class SizeType, unsigned int alignmentBits, bool cheksummingOn = false, bool statsOn = false, unsigned int flCount = 16, unsigned int slCount = 16>
+using TlsfHeap = Heap<TlsfPolicy<SizeType, flCount, slCount>, SizeType, alignmentBits, cheksummingOn, statsOn>;
 
 }
 
@@ -0,0 +1,93 @@
+/*******************************************************************************
+ *
+ * Copyright (c) 2026 Tamás Seller. All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *******************************************************************************/
+
+#ifndef PET_MANAGED_OFFSETPTR_H_
+#define PET_MANAGED_OFFSETPTR_H_
+
+#include "platform/Compiler.h"
+
+#include <stdint.h>
+
+namespace pet
+{
+
+/**
+ * Self-relative pointer.
+ *
+ * Stores the distance of the target from its own location instead of the address,
+ * so a data structure that is linked with these remains valid if it is moved as a
+ * whole, or mapped at different addresses (like a memory mapped file or shared memory
+ * in different processes). It is meant to be used for the links of the objects stored
+ * in a PersistentHeap or a shared memory heap.
+ *
+ * Copying an OffsetPtr copies the target (not the offset), so it can be freely moved
+ * between objects inside and outside of the mapped area, but it only stays valid across
+ * remapping if both it and its target are inside the same area.
+ *
+ * @note	A pointer to itself can not be represented, as the zero offset means null.
+ */
+template<class T>
+class OffsetPtr
+{
+    intptr_t offset = 0;
+
+    really_inline void set(T* target) {
+        offset = target ? reinterpret_cast<intptr_t>(target) - reinterpret_cast<intptr_t>(this) : 0;
+    }
+
+public:
+    really_inline OffsetPtr() = default;
+    really_inline OffsetPtr(decltype(nullptr)) {}
+    really_inline OffsetPtr(T* target) { set(target); }
+    really_inline OffsetPtr(const OffsetPtr &other) { set(other.get()); }
+
+    really_inline OffsetPtr& operator =(const OffsetPtr &other)
+    {
+        set(other.get());
+        return *this;
+    }
+
+    really_inline OffsetPtr& operator =(T* target)
+    {
+        set(target);
+        return *this;
+    }
+
+    /// Get the address of the target.
+    really_inline T* get() const {
+        return offset ? reinterpret_cast<T*>(reinterpret_cast<intptr_t>(this) + offset) : nullptr;
+    }
+
+    really_inline operator T*() const {
+        return get();
+    }
+
+    really_inline T* operator ->() const {
+        return get();
+    }
+
+    template<class U = T>
+    really_inline U& operator *() const {
+        return *get();
+    }
+};
+
+}
+
+#endif /* PET_MANAGED_OFFSETPTR_H_ */
@@ -40,6 +40,54 @@ static inline uint32_t clz(uint32_t x) {
 
 #endif
 
+#include <stdint.h>
+
+/**
+ * Position of the highest set bit of a non-zero integer of up to 64 bits.
+ */
+template<typename N>
+static inline unsigned int msbIndex(N n)
+{
+#if defined(PET_COMPILER_IS_GCC)
+    if(sizeof(N) <= sizeof(unsigned int))
+        return sizeof(unsigned int) * 8 - 1 - __builtin_clz((unsigned int)n);
+    else
+        return sizeof(unsigned long long) * 8 - 1 - __builtin_clzll((unsigned long long)n);
+#elif defined(PET_COMPILER_IS_MSVC)
+    unsigned long r = 0;
+
+    if(sizeof(N) <= sizeof(uint32_t))
+        _BitScanReverse(&r, (uint32_t)n);
+    else
+        _BitScanReverse64(&r, (uint64_t)n);
+
+    return r;
+#endif
+}
+
+/**
+ * Position of the lowest set bit of a non-zero integer of up to 64 bits.
+ */
+template<typename N>
+static inline unsigned int lsbIndex(N n)
+{
+#if defined(PET_COMPILER_IS_GCC)
+    if(sizeof(N) <= sizeof(unsigned int))
+        return __builtin_ctz((unsigned int)n);
+    else
+        return __builtin_ctzll((unsigned long long)n);
+#elif defined(PET_COMPILER_IS_MSVC)
+    unsigned long r = 0;
+
+    if(sizeof(N) <= sizeof(uint32_t))
+        _BitScanForward(&r, (uint32_t)n);
+    else
+        _BitScanForward64(&r, (uint64_t)n);
+
+    return r;
+#endif
+}
+
 template<typename N>
 constexpr static inline size_t ilog2(N n) {
     return (n<2) ? 0 : 1 + ilog2((n + 1) / 2);
@@ -0,0 +1,44 @@
+/*******************************************************************************
+ *
+ * Copyright (c) 2026 Tamás Seller. All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *******************************************************************************/
+
+#ifndef PET_PLATFORM_LINUX_CURRENTCPUSELECTOR_H_
+#define PET_PLATFORM_LINUX_CURRENTCPUSELECTOR_H_
+
+#include <sched.h>
+
+namespace pet {
+
+/**
+ * Arena selector for the ShardedHeap that picks the arena of the CPU the caller runs on.
+ *
+ * The thread may be migrated to another CPU right after the query, which only makes it
+ * use a different arena (the arenas have their own locks), so it is not a problem.
+ */
+struct CurrentCpuSelector
+{
+    static inline unsigned int current()
+    {
+        const int cpu = sched_getcpu();
+        return (cpu < 0) ? 0 : unsigned(cpu);
+    }
+};
+
+}
+
+#endif /* PET_PLATFORM_LINUX_CURRENTCPUSELECTOR_H_ */
@@ -0,0 +1,131 @@
+/*******************************************************************************
+ *
+ * Copyright (c) 2026 Tamás Seller. All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *******************************************************************************/
+
+#ifndef PET_PLATFORM_LINUX_HUGEPAGEPROVIDER_H_
+#define PET_PLATFORM_LINUX_HUGEPAGEPROVIDER_H_
+
+#include <sys/mman.h>
+
+#include <stdint.h>
+
+namespace pet {
+
+/**
+ * Memory provider that maps areas backed by huge pages.
+ *
+ * Large heaps touched all over (like the ones behind big containers) suffer from TLB misses
+ * when backed by normal pages. This provider maps areas in multiples of the huge page size
+ * (2 MiB), aligned to it. It first tries to get explicit huge pages (_MAP_HUGETLB_), that
+ * have to be reserved by the administrator, and if there are none, it falls back to normal
+ * pages with the transparent huge page hint (_MADV_HUGEPAGE_), which the kernel honors
+ * if it can.
+ *
+ * It has the same interface as the MmapProvider, so it can be used as the _Provider_
+ * of the GrowingHeap (with a _chunkSize_ that is a multiple of the huge page size) or to
+ * get the area for a Heap or BuddyAllocator. Since the areas are aligned to the huge page
+ * size, the heap space starts at a huge page boundary (the block headers do not make the
+ * first page straddle two huge pages), and the areas of a power-of-two sized buddy
+ * allocator of at least 2 MiB exactly cover whole huge pages.
+ */
+struct HugePageProvider
+{
+    /// The size of the huge pages (the most common one on x86-64 and arm64).
+    static constexpr uintptr_t hugePageSize = 2 * 1024 * 1024;
+
+    /// Round up to whole huge pages.
+    static inline uintptr_t roundUp(uintptr_t size) {
+        return (size + hugePageSize - 1) & ~(hugePageSize - 1);
+    }
+
+    /**
+     * Map a new area, the size is rounded up to whole huge pages.
+     *
+     * @return	The start of the area (aligned to the huge page size) or NULL on failure.
+     */
+    static inline void* acquire(uintptr_t size)
+    {
+        size = roundUp(size);
+
+#ifdef MAP_HUGETLB
+        void* ret = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+
+        if(ret != MAP_FAILED)
+        {
+            return ret;
+        }
+#endif
+
+        /*
+         * Map one more huge page than needed, so that an aligned area
+         * can be cut out of it, and unmap the surplus on both ends.
+         */
+        const auto raw = static_cast<char*>(mmap(nullptr, size + hugePageSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0));
+
+        if(raw == MAP_FAILED)
+        {
+            return nullptr;
+        }
+
+        const auto aligned = reinterpret_cast<char*>(roundUp(reinterpret_cast<uintptr_t>(raw)));
+
+        if(aligned != raw)
+        {
+            munmap(raw, aligned - raw);
+        }
+
+        if(const uintptr_t tail = raw + hugePageSize - aligned)
+        {
+            munmap(aligned + size, tail);
+        }
+
+#ifdef MADV_HUGEPAGE
+        madvise(aligned, size, MADV_HUGEPAGE);
+#endif
+
+        return aligned;
+    }
+
+    /**
+     * Unmap an area, obtained via _acquire_ with the same size.
+     */
+    static inline void release(void* ptr, uintptr_t size) {
+        munmap(ptr, roundUp(size));
+    }
+
+    /**
+     * Give back the physical pages of a huge page aligned range, keeping it mapped.
+     *
+     * @see	MmapProvider::discard
+     */
+    static inline void discard(void* ptr, uintptr_t size) {
+        madvise(ptr, size, MADV_DONTNEED);
+    }
+
+    /**
+     * The granularity of the mapping and discarding (discarding parts of
+     * huge pages would break them up, so only whole ones are given back).
+     */
+    static constexpr inline uintptr_t pageSize() {
+        return hugePageSize;
+    }
+};
+
+}
+
+#endif /* PET_PLATFORM_LINUX_HUGEPAGEPROVIDER_H_ */
@@ -0,0 +1,110 @@
+/*******************************************************************************
+ *
+ * Copyright (c) 2026 Tamás Seller. All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *******************************************************************************/
+
+#ifndef PET_PLATFORM_LINUX_MAPPEDFILE_H_
+#define PET_PLATFORM_LINUX_MAPPEDFILE_H_
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <stdint.h>
+
+namespace pet {
+
+/**
+ * Shared memory mapping of a file.
+ *
+ * Can be used as the persistent area of a PersistentHeap. The file is created (filled
+ * with zeroes) or extended to the requested size if it is shorter.
+ */
+class MappedFile
+{
+    void* area = nullptr;
+    uintptr_t size = 0;
+
+public:
+    inline MappedFile() = default;
+    MappedFile(const MappedFile&) = delete;
+
+    inline ~MappedFile() {
+        close();
+    }
+
+    /**
+     * Map a file.
+     *
+     * @param	path The path of the file.
+     * @param	size The size of the mapping.
+     * @return	The start of the mapped area or NULL on failure.
+     */
+    inline void* open(const char* path, uintptr_t size)
+    {
+        close();
+
+        const int fd = ::open(path, O_RDWR | O_CREAT, 0600);
+
+        if(fd < 0)
+        {
+            return nullptr;
+        }
+
+        struct stat st;
+
+        if(fstat(fd, &st) == 0 && (uintptr_t(st.st_size) >= size || ftruncate(fd, size) == 0))
+        {
+            void* ret = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+
+            if(ret != MAP_FAILED)
+            {
+                area = ret;
+                this->size = size;
+            }
+        }
+
+        ::close(fd);
+        return area;
+    }
+
+    /**
+     * Write back the modified contents to the file synchronously.
+     *
+     * @return	True on success.
+     */
+    inline bool sync() {
+        return area && msync(area, size, MS_SYNC) == 0;
+    }
+
+    /**
+     * Unmap the file (the modifications are written back eventually by the system).
+     */
+    inline void close()
+    {
+        if(area)
+        {
+            munmap(area, size);
+            area = nullptr;
+        }
+    }
+};
+
+}
+
+#endif /* PET_PLATFORM_LINUX_MAPPEDFILE_H_ */
@@ -0,0 +1,79 @@
+/*******************************************************************************
+ *
+ * Copyright (c) 2026 Tamás Seller. All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *******************************************************************************/
+
+#ifndef PET_PLATFORM_LINUX_MMAPPROVIDER_H_
+#define PET_PLATFORM_LINUX_MMAPPROVIDER_H_
+
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <stdint.h>
+
+namespace pet {
+
+/**
+ * Memory provider that maps anonymous private pages from the operating system.
+ *
+ * Can be used as the _Provider_ of the GrowingHeap, the sizes requested should be
+ * multiples of the page size. The pages are backed by physical memory only when
+ * they are first touched, and given back to the system when released (or discarded).
+ */
+struct MmapProvider
+{
+    /**
+     * Map a new area.
+     *
+     * @return	The start of the area or NULL on failure.
+     */
+    static inline void* acquire(uintptr_t size)
+    {
+        void* ret = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        return ret != MAP_FAILED ? ret : nullptr;
+    }
+
+    /**
+     * Unmap an area, obtained via _acquire_ with the same size.
+     */
+    static inline void release(void* ptr, uintptr_t size) {
+        munmap(ptr, size);
+    }
+
+    /**
+     * Give back the physical pages of a page aligned range, keeping it mapped.
+     *
+     * The range reads as zeroes afterwards, and gets backed by memory again when touched.
+     * It can be used as the _discard_ function for Heap::trim.
+     */
+    static inline void discard(void* ptr, uintptr_t size) {
+        madvise(ptr, size, MADV_DONTNEED);
+    }
+
+    /**
+     * The granularity of the mapping and discarding.
+     */
+    static inline uintptr_t pageSize()
+    {
+        static const uintptr_t ret = sysconf(_SC_PAGESIZE);
+        return ret;
+    }
+};
+
+}
+
+#endif /* PET_PLATFORM_LINUX_MMAPPROVIDER_H_ */
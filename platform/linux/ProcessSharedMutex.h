@@ -0,0 +1,94 @@
+/*******************************************************************************
+ *
+ * Copyright (c) 2026 Tamás Seller. All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *******************************************************************************/
+
+#ifndef PET_PLATFORM_LINUX_PROCESSSHAREDMUTEX_H_
+#define PET_PLATFORM_LINUX_PROCESSSHAREDMUTEX_H_
+
+#include <pthread.h>
+#include <errno.h>
+
+namespace pet {
+
+/**
+ * Mutex that can be placed in shared memory and used by multiple processes.
+ *
+ * It is a robust mutex: if a process dies while holding it, the next process that locks
+ * it takes it over (instead of blocking forever). The data guarded by it may have been
+ * left in an inconsistent state in that case, which can be queried via _wasAbandoned_, or
+ * via _takeAbandoned_ by the holder of the lock, that is responsible for the recovery.
+ *
+ * @note	It must be constructed in the shared memory by one of the processes before
+ * 			any of the others use it, and it can not be moved or copied.
+ */
+class ProcessSharedMutex
+{
+    pthread_mutex_t mutex;
+    volatile bool abandoned = false;
+    volatile bool unrecovered = false;
+
+public:
+    inline ProcessSharedMutex()
+    {
+        pthread_mutexattr_t attr;
+        pthread_mutexattr_init(&attr);
+        pthread_mutexattr_setpshared(&attr, PTHREAD_PROCESS_SHARED);
+        pthread_mutexattr_setrobust(&attr, PTHREAD_MUTEX_ROBUST);
+        pthread_mutex_init(&mutex, &attr);
+        pthread_mutexattr_destroy(&attr);
+    }
+
+    ProcessSharedMutex(const ProcessSharedMutex&) = delete;
+
+    inline void lock()
+    {
+        if(pthread_mutex_lock(&mutex) == EOWNERDEAD)
+        {
+            abandoned = unrecovered = true;
+            pthread_mutex_consistent(&mutex);
+        }
+    }
+
+    inline void unlock() {
+        pthread_mutex_unlock(&mutex);
+    }
+
+    /**
+     * Check whether a process died while holding the lock (sticky).
+     */
+    inline bool wasAbandoned() const {
+        return abandoned;
+    }
+
+    /**
+     * Check whether the lock was taken over from a dead process since the last call.
+     *
+     * Must be called while holding the lock, each abandonment is reported only once,
+     * so that the recovery of the guarded data is done by a single process.
+     */
+    inline bool takeAbandoned()
+    {
+        const bool ret = unrecovered;
+        unrecovered = false;
+        return ret;
+    }
+};
+
+}
+
+#endif /* PET_PLATFORM_LINUX_PROCESSSHAREDMUTEX_H_ */
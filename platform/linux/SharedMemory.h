@@ -0,0 +1,143 @@
+/*******************************************************************************
+ *
+ * Copyright (c) 2026 Tamás Seller. All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *******************************************************************************/
+
+#ifndef PET_PLATFORM_LINUX_SHAREDMEMORY_H_
+#define PET_PLATFORM_LINUX_SHAREDMEMORY_H_
+
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <stdint.h>
+
+namespace pet {
+
+/**
+ * Shared memory mapping that can be used by multiple processes.
+ *
+ * The memory object can either be a named POSIX shared memory object (_shm_open_),
+ * or an anonymous one (_memfd_create_), whose file descriptor can be inherited by
+ * child processes or sent to other ones over a unix domain socket. Each process may
+ * get the area mapped at a different address.
+ */
+class SharedMemory
+{
+    void* area = nullptr;
+    uintptr_t size = 0;
+    int fd = -1;
+
+public:
+    inline SharedMemory() = default;
+    SharedMemory(const SharedMemory&) = delete;
+
+    inline ~SharedMemory() {
+        close();
+    }
+
+    /**
+     * Map a memory object by its file descriptor (that is kept open until _close_).
+     *
+     * @param	fd The file descriptor of the memory object.
+     * @param	size The size of the mapping, the object is extended if it is shorter.
+     * @return	The start of the mapped area or NULL on failure.
+     */
+    inline void* map(int fd, uintptr_t size)
+    {
+        close();
+
+        if(fd < 0)
+        {
+            return nullptr;
+        }
+
+        this->fd = fd;
+
+        if(lseek(fd, 0, SEEK_END) < off_t(size) && ftruncate(fd, size) != 0)
+        {
+            return nullptr;
+        }
+
+        void* ret = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+
+        if(ret != MAP_FAILED)
+        {
+            area = ret;
+            this->size = size;
+        }
+
+        return area;
+    }
+
+    /**
+     * Map a named shared memory object, creating it if it does not exist.
+     *
+     * @param	name The name of the object (starting with a slash).
+     * @param	size The size of the mapping.
+     * @return	The start of the mapped area or NULL on failure.
+     */
+    inline void* open(const char* name, uintptr_t size) {
+        return map(shm_open(name, O_RDWR | O_CREAT, 0600), size);
+    }
+
+    /**
+     * Create and map an anonymous shared memory object.
+     *
+     * @param	size The size of the mapping.
+     * @return	The start of the mapped area or NULL on failure.
+     */
+    inline void* create(uintptr_t size) {
+        return map(memfd_create("pet-shared", MFD_CLOEXEC), size);
+    }
+
+    /**
+     * The file descriptor of the memory object, that can be passed to other processes.
+     */
+    inline int getFd() const {
+        return fd;
+    }
+
+    /**
+     * Remove a named shared memory object (the existing mappings stay valid).
+     */
+    static inline bool remove(const char* name) {
+        return shm_unlink(name) == 0;
+    }
+
+    /**
+     * Unmap the area and close the file descriptor.
+     */
+    inline void close()
+    {
+        if(area)
+        {
+            munmap(area, size);
+            area = nullptr;
+        }
+
+        if(fd >= 0)
+        {
+            ::close(fd);
+            fd = -1;
+        }
+    }
+};
+
+}
+
+#endif /* PET_PLATFORM_LINUX_SHAREDMEMORY_H_ */
@@ -0,0 +1,416 @@
+/*******************************************************************************
+ *
+ * Copyright (c) 2026 Tamás Seller. All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *******************************************************************************/
+
+/*
+ * Replacement of the stdlibc dynamic memory management functions, based on the TLSF heap.
+ *
+ * Meant to be built as a shared library, and loaded into unmodified programs via LD_PRELOAD:
+ *
+ *     g++ -std=c++17 -O2 -fPIC -shared -fno-exceptions -I<pet> -I<dir of DebugConfig.h> \
+ *         platform/linux/TlsfMalloc.cpp -o libpetmalloc.so -lpthread
+ *     LD_PRELOAD=./libpetmalloc.so PET_MALLOC_STATS=1 <program>
+ *
+ * It is deliberately not part of the default source list (mod.mk), as linking it into a program
+ * replaces the allocator of the whole process. The DebugConfig.h used for the build must not
+ * enable any trace output for the heaps that allocates memory (the default configuration that
+ * only reports failures is suitable if the writer itself does not allocate).
+ *
+ * The small requests are served by a growing TLSF heap on chunks mapped from the system, the
+ * large ones are mapped individually (like the stdlibc does above its mmap threshold). A single
+ * lock guards the heap, it is held across fork so that the child inherits a consistent heap.
+ *
+ * If the PET_MALLOC_STATS environment variable is set, the statistics of the heap are written
+ * to the standard error output at exit.
+ */
+
+#include "heap/GrowingHeap.h"
+#include "heap/TlsfPolicy.h"
+
+#include "meta/Resettable.h"
+#include "platform/linux/MmapProvider.h"
+
+#include <pthread.h>
+#include <unistd.h>
+#include <errno.h>
+#include <stdlib.h>
+
+namespace {
+
+/// Requests not smaller than this are mapped directly.
+constexpr uintptr_t largeThreshold = 256 * 1024;
+
+/// The minimal size of the chunks of the heap.
+constexpr uintptr_t chunkSize = 4 * 1024 * 1024;
+
+using Heap = pet::GrowingHeap<pet::TlsfHeap<uint32_t, 4, false, true>, pet::MmapProvider, chunkSize>;
+
+/**
+ * Header of the directly mapped blocks, placed right before the data.
+ *
+ * The last field overlaps with the header fields of the heap blocks, that are
+ * never all zero, so it tells apart the two kinds of blocks.
+ */
+struct LargeHeader
+{
+    void* base;
+    uintptr_t length;
+    uint64_t marker;
+};
+
+alignas(Heap) char heapStorage[sizeof(Heap)];
+Heap* heap;
+
+pthread_mutex_t mutex = PTHREAD_MUTEX_INITIALIZER;
+
+uintptr_t nLarge, largeBytes, peakLargeBytes;
+
+struct Lock
+{
+    inline Lock() { pthread_mutex_lock(&mutex); }
+    inline ~Lock() { pthread_mutex_unlock(&mutex); }
+};
+
+void forkPrepare() {
+    pthread_mutex_lock(&mutex);
+}
+
+void forkParent() {
+    pthread_mutex_unlock(&mutex);
+}
+
+void forkChild() {
+    pthread_mutex_init(&mutex, nullptr);
+}
+
+/// Must be called with the lock held.
+inline Heap& getHeap()
+{
+    if(unlikely(!heap))
+    {
+        heap = new(heapStorage, NewOperatorDisambiguator()) Heap;
+        pthread_atfork(&forkPrepare, &forkParent, &forkChild);
+    }
+
+    return *heap;
+}
+
+inline bool isLarge(void* ptr) {
+    return static_cast<LargeHeader*>(ptr)[-1].marker == 0;
+}
+
+void* allocLarge(uintptr_t size, uintptr_t align)
+{
+    const uintptr_t pageSize = pet::MmapProvider::pageSize();
+    const uintptr_t front = (sizeof(LargeHeader) + align - 1) & ~(align - 1);
+    const uintptr_t extra = front + (align > pageSize ? align : 0) + pageSize - 1;
+
+    if(size > UINTPTR_MAX - extra)
+    {
+        return nullptr;
+    }
+
+    const uintptr_t length = (size + extra) & ~(pageSize - 1);
+
+    char* base = static_cast<char*>(pet::MmapProvider::acquire(length));
+
+    if(!base)
+    {
+        return nullptr;
+    }
+
+    char* ret = reinterpret_cast<char*>((reinterpret_cast<uintptr_t>(base) + front + align - 1) & ~(align - 1));
+
+    auto header = reinterpret_cast<LargeHeader*>(ret) - 1;
+    header->base = base;
+    header->length = length;
+    header->marker = 0;
+
+    Lock lock;
+    nLarge++;
+
+    if(peakLargeBytes < (largeBytes += length))
+    {
+        peakLargeBytes = largeBytes;
+    }
+
+    return ret;
+}
+
+void freeLarge(void* ptr)
+{
+    const auto header = static_cast<LargeHeader*>(ptr) - 1;
+    const uintptr_t length = header->length;
+
+    pet::MmapProvider::release(header->base, length);
+
+    Lock lock;
+    nLarge--;
+    largeBytes -= length;
+}
+
+inline uintptr_t usableSize(void* ptr)
+{
+    if(isLarge(ptr))
+    {
+        const auto header = static_cast<LargeHeader*>(ptr) - 1;
+        return static_cast<char*>(header->base) + header->length - static_cast<char*>(ptr);
+    }
+
+    return Heap::getSize(ptr);
+}
+
+void* allocate(uintptr_t size, uintptr_t align)
+{
+    if(align < pet::TlsfHeap<uint32_t, 4>::alignment)
+    {
+        align = pet::TlsfHeap<uint32_t, 4>::alignment;
+    }
+
+    if(size > UINTPTR_MAX - align)
+    {
+        errno = ENOMEM;
+        return nullptr;
+    }
+
+    void* ret;
+
+    if(align < largeThreshold && size < largeThreshold - align)
+    {
+        Lock lock;
+        ret = getHeap().allocAligned(size, align);
+    }
+    else
+    {
+        ret = allocLarge(size, align);
+    }
+
+    if(!ret)
+    {
+        errno = ENOMEM;
+    }
+
+    return ret;
+}
+
+void release(void* ptr)
+{
+    if(ptr)
+    {
+        if(isLarge(ptr))
+        {
+            freeLarge(ptr);
+        }
+        else
+        {
+            Lock lock;
+            getHeap().free(ptr);
+        }
+    }
+}
+
+/// Write a labeled number to the standard error output (without allocating).
+void dump(const char* label, uintptr_t value)
+{
+    char buffer[64];
+    char* p = buffer;
+
+    while(*label)
+    {
+        *p++ = *label++;
+    }
+
+    char digits[24];
+    int n = 0;
+
+    do
+    {
+        digits[n++] = '0' + value % 10;
+        value /= 10;
+    }
+    while(value);
+
+    while(n)
+    {
+        *p++ = digits[--n];
+    }
+
+    *p++ = '\n';
+
+    if(write(2, buffer, p - buffer) < 0)
+    {
+        return;
+    }
+}
+
+__attribute__((destructor)) void dumpStats()
+{
+    if(!getenv("PET_MALLOC_STATS"))
+    {
+        return;
+    }
+
+    Lock lock;
+
+    if(heap)
+    {
+        const auto stats = heap->getStats();
+        dump("pet-malloc used blocks: ", stats.nUsed);
+        dump("pet-malloc used bytes: ", stats.totalUsed);
+        dump("pet-malloc free bytes: ", stats.totalFree);
+        dump("pet-malloc largest free block: ", stats.longestFree);
+    }
+
+    dump("pet-malloc mapped blocks: ", nLarge);
+    dump("pet-malloc mapped bytes: ", largeBytes);
+    dump("pet-malloc peak mapped bytes: ", peakLargeBytes);
+}
+
+}
+
+extern "C" {
+
+void* malloc(size_t size) {
+    return allocate(size, 0);
+}
+
+void free(void* ptr) {
+    release(ptr);
+}
+
+void* calloc(size_t n, size_t size)
+{
+    const size_t total = n * size;
+
+    if(size && total / size != n)
+    {
+        errno = ENOMEM;
+        return nullptr;
+    }
+
+    void* ret = allocate(total, 0);
+
+    // The directly mapped blocks are zeroed by the system.
+    if(ret && !isLarge(ret))
+    {
+        auto p = static_cast<uint64_t*>(ret);
+
+        for(auto n = (total + sizeof(uint64_t) - 1) / sizeof(uint64_t); n--;)
+        {
+            *p++ = 0;
+        }
+    }
+
+    return ret;
+}
+
+void* realloc(void* ptr, size_t size)
+{
+    if(!ptr)
+    {
+        return allocate(size, 0);
+    }
+
+    if(!size)
+    {
+        release(ptr);
+        return nullptr;
+    }
+
+    const uintptr_t oldSize = usableSize(ptr);
+
+    if(!isLarge(ptr) && size < largeThreshold)
+    {
+        Lock lock;
+
+        if(void* ret = getHeap().reallocate(ptr, size))
+        {
+            return ret;
+        }
+    }
+    else if(isLarge(ptr) && size <= oldSize && oldSize / 2 <= size)
+    {
+        return ptr;
+    }
+
+    void* ret = allocate(size, 0);
+
+    if(ret)
+    {
+        auto d = static_cast<char*>(ret);
+        auto s = static_cast<const char*>(ptr);
+
+        for(auto n = oldSize < size ? oldSize : size; n--;)
+        {
+            *d++ = *s++;
+        }
+
+        release(ptr);
+    }
+
+    return ret;
+}
+
+void* memalign(size_t align, size_t size)
+{
+    if(!align || (align & (align - 1)))
+    {
+        errno = EINVAL;
+        return nullptr;
+    }
+
+    return allocate(size, align);
+}
+
+void* aligned_alloc(size_t align, size_t size) {
+    return memalign(align, size);
+}
+
+int posix_memalign(void** out, size_t align, size_t size)
+{
+    if(!align || (align & (align - 1)) || (align % sizeof(void*)))
+    {
+        return EINVAL;
+    }
+
+    void* ret = allocate(size, align);
+
+    if(!ret)
+    {
+        return ENOMEM;
+    }
+
+    *out = ret;
+    return 0;
+}
+
+void* valloc(size_t size) {
+    return allocate(size, pet::MmapProvider::pageSize());
+}
+
+void* pvalloc(size_t size)
+{
+    const uintptr_t pageSize = pet::MmapProvider::pageSize();
+    return allocate((size + pageSize - 1) & ~(pageSize - 1), pageSize);
+}
+
+size_t malloc_usable_size(void* ptr) {
+    return ptr ? usableSize(ptr) : 0;
+}
+
+}
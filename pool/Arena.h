@@ -0,0 +1,318 @@
+/*******************************************************************************
+ *
+ * Copyright (c) 2026 Tamás Seller. All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *******************************************************************************/
+
+#ifndef PET_POOL_ARENA_H_
+#define PET_POOL_ARENA_H_
+
+#include "pool/Pool.h"
+#include "pool/StaticAllocator.h"
+
+namespace pet {
+
+/**
+ * Bump allocator.
+ *
+ * Hands out memory from chunks by simply moving a pointer forward, individual blocks
+ * can not be released. Instead the state of the arena can be saved in a Marker and
+ * then later everything allocated since can be released at once, by rewinding to it.
+ * Rewinding (or resetting) is a constant time operation, the chunks are not given back,
+ * but reused by the subsequent allocations.
+ *
+ * The chunks are obtained from a backing allocator on demand, and optionally a static
+ * storage area can also be provided to be used as the first chunk.
+ *
+ * Can be used as the _Allocator_ for TreeMap directly, or via the StaticAllocator
+ * adapter for the Unique and RefCnt managed pointers, in which case releasing an
+ * object does nothing.
+ *
+ * @tparam	Allocator The backing allocator, it has to provide the static _alloc_ and
+ * 			_free_ methods (@see heap.md). The NullAllocator can be used, to have an
+ * 			arena that uses only the static storage provided on construction.
+ * @tparam	chunkSize The minimal amount of memory requested from the backing allocator.
+ * @tparam	alignment The alignment of the blocks returned (has to be a power of two).
+ */
+template<class Allocator = NullAllocator, uintptr_t chunkSize = 1024, uintptr_t alignment = sizeof(void*)>
+class Arena: pet::Trace<AllPoolsTrace>
+{
+    static_assert(alignment && !(alignment & (alignment - 1)), "alignment must be a power of two");
+
+    /**
+     * Header of a chunk of storage.
+     *
+     * Placed at the start of the chunk itself.
+     */
+    struct Chunk
+    {
+        Chunk* next;
+        char* end;
+        bool owned;
+    };
+
+    /// All the chunks, in the order of usage.
+    Chunk* first = nullptr;
+
+    /// The chunk that allocations are currently served from.
+    Chunk* current = nullptr;
+
+    /// The start and the end of the free space in the current chunk.
+    char *next = nullptr, *limit = nullptr;
+
+    static really_inline char* alignUp(char* ptr) {
+        return reinterpret_cast<char*>((reinterpret_cast<uintptr_t>(ptr) + alignment - 1) & ~(alignment - 1));
+    }
+
+    static really_inline char* data(Chunk* chunk) {
+        return reinterpret_cast<char*>(chunk + 1);
+    }
+
+    /// Check if _size_ bytes fit between _from_ and _end_ (_from_ may be past _end_ after aligning).
+    static really_inline bool hasRoom(char* from, char* end, uintptr_t size) {
+        return from <= end && size <= uintptr_t(end - from);
+    }
+
+    static inline bool fits(Chunk* chunk, uintptr_t size) {
+        return hasRoom(alignUp(data(chunk)), chunk->end, size);
+    }
+
+    inline void use(Chunk* chunk)
+    {
+        current = chunk;
+        next = data(chunk);
+        limit = chunk->end;
+    }
+
+    /**
+     * Move on to the next chunk that can hold the requested amount.
+     *
+     * The ones that are too small are skipped, if there is none that fits
+     * a new one is obtained from the backing allocator and inserted after
+     * the current one.
+     */
+    inline bool advance(uintptr_t size)
+    {
+        Chunk** link = current ? &current->next : &first;
+
+        while(*link)
+        {
+            if(fits(*link, size))
+            {
+                use(*link);
+                return true;
+            }
+
+            link = &(*link)->next;
+        }
+
+        if(size > uintptr_t(-1) - sizeof(Chunk) - alignment)
+            return false;
+
+        const uintptr_t needed = sizeof(Chunk) + alignment + size;
+        const uintptr_t total = needed < chunkSize ? chunkSize : needed;
+
+        Chunk* chunk = static_cast<Chunk*>(Allocator::alloc(total));
+
+        if(!chunk)
+            return false;
+
+        chunk->end = reinterpret_cast<char*>(chunk) + total;
+        chunk->owned = true;
+
+        Chunk** at = current ? &current->next : &first;
+        chunk->next = *at;
+        *at = chunk;
+
+        use(chunk);
+        return true;
+    }
+
+public:
+    /**
+     * Saved state of the arena.
+     *
+     * @see rewind
+     */
+    class Marker
+    {
+        friend Arena;
+        Chunk* chunk;
+        char* next;
+
+        really_inline Marker(Chunk* chunk, char* next): chunk(chunk), next(next) {}
+    };
+
+    /**
+     * Scope guard, that rewinds the arena to the state in which it was
+     * when the guard was created.
+     */
+    class Scope
+    {
+        Arena &arena;
+        const Marker marker;
+
+    public:
+        really_inline Scope(Arena &arena): arena(arena), marker(arena.mark()) {}
+        really_inline ~Scope() { arena.rewind(marker); }
+        Scope(const Scope&) = delete;
+    };
+
+    /**
+     * Create an empty arena, that obtains all of its storage from the backing allocator.
+     */
+    inline Arena() = default;
+
+    /**
+     * Create an arena that uses the provided storage area first.
+     *
+     * @param	storage The start of the area, it is not freed on release.
+     * @param	size The size of the area in bytes (has to be larger than a few pointers).
+     */
+    inline Arena(void* storage, uintptr_t size)
+    {
+        assertThat(sizeof(Chunk) < size, "Arena::Arena(): Invalid argument\n");
+
+        Chunk* chunk = static_cast<Chunk*>(storage);
+        chunk->next = nullptr;
+        chunk->end = static_cast<char*>(storage) + size;
+        chunk->owned = false;
+        first = chunk;
+        use(chunk);
+    }
+
+    Arena(const Arena&) = delete;
+
+    /**
+     * Give back the chunks to the backing allocator.
+     */
+    inline ~Arena() {
+        release();
+    }
+
+    /**
+     * Allocate memory.
+     *
+     * @param	size The amount (in bytes) to be allocated.
+     * @return	A pointer to the start of the allocated region or NULL on failure.
+     */
+    inline void* alloc(uintptr_t size)
+    {
+        char* ret = alignUp(next);
+
+        if(unlikely(!current || !hasRoom(ret, limit, size)))
+        {
+            if(!advance(size))
+                return nullptr;
+
+            ret = alignUp(next);
+        }
+
+        next = ret + size;
+        return ret;
+    }
+
+    /**
+     * Allocate memory for an object of type T.
+     */
+    template<class T>
+    inline void* allocFor()
+    {
+        static_assert(alignof(T) <= alignment, "Object requires larger alignment than that of the arena");
+        return alloc(sizeof(T));
+    }
+
+    /**
+     * Release memory, does nothing.
+     *
+     * Allocations can only be released by rewinding or resetting the arena.
+     */
+    really_inline void free(void*) {}
+
+    /**
+     * Save the current state.
+     */
+    really_inline Marker mark() const {
+        return Marker(current, next);
+    }
+
+    /**
+     * Release everything that has been allocated since the marker was taken.
+     *
+     * @param	marker A state saved after the last reset and not invalidated by rewinding
+     * 			to an earlier one.
+     */
+    inline void rewind(const Marker &marker)
+    {
+        if(marker.chunk)
+        {
+            current = marker.chunk;
+            next = marker.next;
+            limit = current->end;
+        }
+        else
+        {
+            reset();
+        }
+    }
+
+    /**
+     * Release everything, keeping the chunks for reuse.
+     */
+    inline void reset()
+    {
+        current = nullptr;
+        next = limit = nullptr;
+
+        if(first && !first->owned)
+            use(first);
+    }
+
+    /**
+     * Release everything, giving back the chunks to the backing allocator.
+     *
+     * The static storage area provided on construction is retained.
+     */
+    inline void release()
+    {
+        Chunk** link = &first;
+
+        while(Chunk* chunk = *link)
+        {
+            if(chunk->owned)
+            {
+                *link = chunk->next;
+                Allocator::free(chunk);
+            }
+            else
+            {
+                link = &chunk->next;
+            }
+        }
+
+        reset();
+    }
+
+    /**
+     * Trace hooks required by the managed containers, do nothing.
+     */
+    static really_inline void traceReferenceAcquistion(...) {}
+    static really_inline void traceReferenceRelease(...) {}
+};
+
+}
+
+#endif /* PET_POOL_ARENA_H_ */
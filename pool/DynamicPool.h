@@ -0,0 +1,135 @@
+/*******************************************************************************
+ *
+ * Copyright (c) 2026 Tamás Seller. All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *******************************************************************************/
+
+#ifndef PET_POOL_DYNAMICPOOL_H_
+#define PET_POOL_DYNAMICPOOL_H_
+
+#include "pool/Pool.h"
+
+namespace pet {
+
+/**
+ * Growable fixed-size element pool.
+ *
+ * Works like the Pool, but instead of a fixed number of embedded slots it obtains
+ * the storage in slabs of several slots from an underlying allocator (typically a
+ * heap, via the StaticAllocator adapter) whenever it runs out of unused slots. This
+ * way the headers, splitting and merging costs of the backing allocator are paid
+ * only once per slab, not for every element.
+ *
+ * Slabs are not given back until the pool is destroyed, the released slots are
+ * kept in the pool for later reuse.
+ *
+ * @tparam	T The type of the elements (or the largest one that is stored in it).
+ * @tparam	Allocator The backing allocator, it has to provide the static _alloc_ and
+ * 			_free_ methods (@see heap.md).
+ * @tparam	slabSize The number of elements allocated in one go.
+ */
+template<class T, class Allocator, size_t slabSize = 16>
+class DynamicPool: public PoolBase<T>
+{
+    static_assert(slabSize > 0, "slab must be able to hold at least one element");
+
+    using Slot = typename PoolBase<T>::Slot;
+
+    /**
+     * A chunk of storage obtained from the backing allocator.
+     *
+     * The link to the next one is stored in front of the slots.
+     */
+    struct Slab
+    {
+        Slab* next;
+        Slot slots[slabSize];
+    };
+
+    /// All the slabs allocated so far.
+    Slab* slabs = nullptr;
+
+    /// Get a new slab and place all of its slots onto the free list.
+    inline bool grow()
+    {
+        Slab* slab = static_cast<Slab*>(Allocator::alloc(sizeof(Slab)));
+
+        if(!slab)
+            return false;
+
+        slab->next = slabs;
+        slabs = slab;
+
+        for(auto i = slabSize; i--;)
+            this->push(slab->slots + i);
+
+        return true;
+    }
+
+    inline Slot* take()
+    {
+        if(!this->first && !grow())
+            return nullptr;
+
+        return this->pop();
+    }
+
+public:
+    inline DynamicPool() = default;
+    DynamicPool(const DynamicPool&) = delete;
+
+    /**
+     * Give back all the slabs to the backing allocator.
+     *
+     * @note	The elements allocated from the pool become invalid.
+     */
+    inline ~DynamicPool()
+    {
+        while(Slab* slab = slabs)
+        {
+            slabs = slab->next;
+            Allocator::free(slab);
+        }
+    }
+
+    /** @copydoc Pool::alloc(uintptr_t) */
+    inline void* alloc(uintptr_t size)
+    {
+        if(size > sizeof(Slot))
+            return nullptr;
+
+        return take();
+    }
+
+    /** @copydoc Pool::allocFor() */
+    template<class U>
+    inline void* allocFor()
+    {
+        static_assert(PoolBase<T>::template canHold<U>, "Object does not fit in the pool slot");
+        return take();
+    }
+
+    /** @copydoc Pool::free(void*) */
+    inline void free(void* ptr)
+    {
+        this->assertThat(ptr, "DynamicPool::free(): Invalid argument\n");
+        this->push(static_cast<Slot*>(ptr));
+    }
+};
+
+}
+
+#endif /* PET_POOL_DYNAMICPOOL_H_ */
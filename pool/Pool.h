@@ -0,0 +1,177 @@
+/*******************************************************************************
+ *
+ * Copyright (c) 2026 Tamás Seller. All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *******************************************************************************/
+
+#ifndef PET_POOL_POOL_H_
+#define PET_POOL_POOL_H_
+
+#include "ubiquitous/Trace.h"
+#include "platform/Compiler.h"
+
+#include <stdint.h>
+#include <stddef.h>
+
+namespace pet {
+
+/**
+ * Trace tag.
+ *
+ * Use this class as an identifier to enable tracing of pool events.
+ */
+class AllPoolsTrace: public pet::Trace<AllPoolsTrace> { static constexpr const char* name = "POOL"; };
+
+/**
+ * Common base for fixed-size element pools.
+ *
+ * Keeps the unused element slots on an intrusive singly linked list, the link
+ * being stored in the otherwise unused storage of the slot itself. Both taking
+ * and putting back a slot is a constant time operation, and there is no per-slot
+ * overhead, apart from the rounding of the size up to that of a pointer.
+ *
+ * Also provides the interface that the managed containers expect from their
+ * _Allocator_ parameter.
+ *
+ * @tparam	T The type of the elements, determines the size and the alignment of the slots.
+ */
+template<class T>
+class PoolBase: protected pet::Trace<AllPoolsTrace>
+{
+protected:
+    /**
+     * Storage for one element.
+     *
+     * Holds the link to the next unused one while it is not in use.
+     */
+    union Slot
+    {
+        Slot* next;
+        alignas(T) char storage[sizeof(T)];
+    };
+
+    /// The first unused slot.
+    Slot* first = nullptr;
+
+    /// Put back a slot to the front of the free list.
+    really_inline void push(Slot* slot)
+    {
+        slot->next = first;
+        first = slot;
+    }
+
+    /// Take a slot from the front of the free list.
+    really_inline Slot* pop()
+    {
+        Slot* ret = first;
+
+        if(ret)
+            first = ret->next;
+
+        return ret;
+    }
+
+public:
+    /**
+     * The size of the slots in bytes.
+     */
+    static constexpr size_t slotSize = sizeof(Slot);
+
+    /**
+     * Tells whether an object of type U can be stored in a slot.
+     */
+    template<class U>
+    static constexpr bool canHold = sizeof(U) <= sizeof(Slot) && alignof(Slot) % alignof(U) == 0;
+
+    /**
+     * Trace hooks required by the managed containers, do nothing.
+     */
+    static really_inline void traceReferenceAcquistion(...) {}
+    static really_inline void traceReferenceRelease(...) {}
+};
+
+/**
+ * Statically sized fixed-size element pool.
+ *
+ * The storage of all the elements is contained in the object itself, so
+ * the pool can be statically allocated or embedded in another object.
+ *
+ * Can be used as the _Allocator_ for TreeMap directly (as it inherits from it),
+ * or via the StaticAllocator adapter for the Unique and RefCnt managed pointers.
+ *
+ * @tparam	T The type of the elements (or the largest one that is stored in it).
+ * @tparam	N The number of elements.
+ */
+template<class T, size_t N>
+class Pool: public PoolBase<T>
+{
+    using Slot = typename PoolBase<T>::Slot;
+    Slot slots[N];
+
+public:
+    /**
+     * Create a pool with all slots unused.
+     */
+    inline Pool()
+    {
+        for(auto i = N; i--;)
+            this->push(slots + i);
+    }
+
+    Pool(const Pool&) = delete;
+
+    /**
+     * Take an unused slot.
+     *
+     * @param	size The requested amount of memory, only used to check that it fits in a slot.
+     * @return	The address of the slot or NULL if there is no unused one (or the size is too large).
+     */
+    inline void* alloc(uintptr_t size)
+    {
+        if(size > sizeof(Slot))
+            return nullptr;
+
+        return this->pop();
+    }
+
+    /**
+     * Take an unused slot for an object of type U.
+     *
+     * @return	The address of the slot or NULL if there is no unused one.
+     */
+    template<class U>
+    inline void* allocFor()
+    {
+        static_assert(PoolBase<T>::template canHold<U>, "Object does not fit in the pool slot");
+        return this->pop();
+    }
+
+    /**
+     * Put back a slot.
+     *
+     * @param	ptr The address of the slot, as returned by _alloc_ or _allocFor_.
+     */
+    inline void free(void* ptr)
+    {
+        Slot* slot = static_cast<Slot*>(ptr);
+        this->assertThat(slots <= slot && slot < slots + N, "Pool::free(): Invalid argument\n");
+        this->push(slot);
+    }
+};
+
+}
+
+#endif /* PET_POOL_POOL_H_ */
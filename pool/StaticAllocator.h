@@ -0,0 +1,90 @@
+/*******************************************************************************
+ *
+ * Copyright (c) 2026 Tamás Seller. All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *******************************************************************************/
+
+#ifndef PET_POOL_STATICALLOCATOR_H_
+#define PET_POOL_STATICALLOCATOR_H_
+
+#include "platform/Compiler.h"
+
+#include <stdint.h>
+
+namespace pet {
+
+/**
+ * Allocator adapter for a statically allocated memory manager object.
+ *
+ * The managed pointers (and the DynamicPool) require an allocator with static
+ * methods, this class provides those by forwarding them to a specific instance
+ * of a heap or pool, that has the non-static _alloc_ and _free_ methods.
+ *
+ * @tparam	instance The statically allocated heap or pool object.
+ */
+template<auto &instance>
+struct StaticAllocator
+{
+    /**
+     * Allocate memory.
+     *
+     * @param	size The amount (in bytes) to be allocated.
+     * @return	A pointer to the start of the allocated region or NULL on failure.
+     */
+    static really_inline void* alloc(uintptr_t size) {
+        return instance.alloc(size);
+    }
+
+    /**
+     * Release memory allocated via _alloc_ or _allocFor_.
+     */
+    static really_inline void free(void* ptr) {
+        instance.free(ptr);
+    }
+
+    /**
+     * Allocate memory for an object of type T.
+     */
+    template<class T>
+    static really_inline void* allocFor() {
+        return instance.alloc(sizeof(T));
+    }
+
+    /**
+     * Trace hooks required by the managed containers, do nothing.
+     */
+    static really_inline void traceReferenceAcquistion(...) {}
+    static really_inline void traceReferenceRelease(...) {}
+};
+
+/**
+ * Backing allocator that can not allocate anything.
+ *
+ * To be used as the backing allocator of the pools that should only
+ * use the storage provided to them explicitly.
+ */
+struct NullAllocator
+{
+    static really_inline void* alloc(uintptr_t) {
+        return nullptr;
+    }
+
+    static really_inline void free(void*) {}
+};
+
+}
+
+#endif /* PET_POOL_STATICALLOCATOR_H_ */
@@ -0,0 +1,103 @@
+/*******************************************************************************
+ *
+ * Copyright (c) 2026 Tamás Seller. All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *******************************************************************************/
+
+#ifndef PET_TESTS_DEBUGCONFIG_H_
+#define PET_TESTS_DEBUGCONFIG_H_
+
+#include "ubiquitous/PrintfWriter.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <new>
+
+/*
+ * Trace writer of the host tests: prints like the PrintfWriter and aborts the
+ * run on failures (like heap corruption), as they can happen on any thread.
+ *
+ * The tests that provoke failures on purpose can have them counted instead
+ * (on the calling thread), see ExpectFailures.
+ */
+struct TestTraceWriter
+{
+    /// The counter of the expected failures of the current thread, if any.
+    static inline thread_local unsigned int* failureCounter = nullptr;
+
+    const bool fatal, quiet;
+
+    union
+    {
+        pet::PrintfWriter writer;
+    };
+
+    inline TestTraceWriter(pet::LogLevel level, const char* name):
+        fatal(level >= pet::LogLevel::Failure), quiet(fatal && failureCounter)
+    {
+        if(!quiet)
+            new(&writer) pet::PrintfWriter(level, name);
+    }
+
+    template<class T>
+    inline TestTraceWriter& operator<<(const T& v)
+    {
+        if(!quiet)
+            writer << v;
+
+        return *this;
+    }
+
+    inline ~TestTraceWriter()
+    {
+        if(quiet)
+        {
+            ++*failureCounter;
+            return;
+        }
+
+        writer.~PrintfWriter();
+
+        if(fatal)
+            abort();
+    }
+};
+
+/*
+ * Counts the failures reported on the current thread while in scope, instead
+ * of printing them and aborting the run.
+ */
+struct ExpectFailures
+{
+    unsigned int count = 0;
+    unsigned int* const outer;
+
+    inline ExpectFailures(): outer(TestTraceWriter::failureCounter) {
+        TestTraceWriter::failureCounter = &count;
+    }
+
+    inline ~ExpectFailures() {
+        TestTraceWriter::failureCounter = outer;
+    }
+
+    ExpectFailures(const ExpectFailures&) = delete;
+};
+
+TRACE_WRITER(TestTraceWriter)
+GLOBAL_TRACE_POLICY(Failure)
+
+#endif /* PET_TESTS_DEBUGCONFIG_H_ */
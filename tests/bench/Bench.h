@@ -0,0 +1,81 @@
+/*******************************************************************************
+ *
+ * Copyright (c) 2026 Tamás Seller. All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *******************************************************************************/
+
+#ifndef PET_TESTS_BENCH_BENCH_H_
+#define PET_TESTS_BENCH_BENCH_H_
+
+#include <chrono>
+#include <thread>
+#include <atomic>
+#include <vector>
+
+#include <stdio.h>
+
+/*
+ * Helpers of the benchmarks, which are registered as 1test test cases in the
+ * bench runner, and report their measurements on the standard output.
+ */
+namespace bench {
+
+/// Wall clock time taken by a call, in seconds.
+template<class F>
+inline double seconds(F &&f)
+{
+    const auto start = std::chrono::steady_clock::now();
+    f();
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+/// Wall clock time taken by _n_ threads started at once to run f(threadIndex), in seconds.
+template<class F>
+inline double secondsParallel(int n, F &&f)
+{
+    std::atomic<bool> go(false);
+    std::atomic<int> ready(0);
+    std::vector<std::thread> threads;
+
+    for(int i = 0; i < n; i++)
+    {
+        threads.emplace_back([&, i]()
+        {
+            ready++;
+            while(!go.load());
+            f(i);
+        });
+    }
+
+    while(ready.load() != n);
+
+    return seconds([&]()
+    {
+        go.store(true);
+
+        for(auto &t: threads)
+            t.join();
+    });
+}
+
+/// Print the header line of a measurement.
+inline void title(const char* text) {
+    printf("\n%s\n", text);
+}
+
+}
+
+#endif /* PET_TESTS_BENCH_BENCH_H_ */
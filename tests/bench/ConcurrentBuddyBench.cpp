@@ -0,0 +1,97 @@
+/*******************************************************************************
+ *
+ * Copyright (c) 2026 Tamás Seller. All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *******************************************************************************/
+
+#include "1test/Test.h"
+
+#include "Bench.h"
+
+#include "heap/ConcurrentBuddy.h"
+
+#include <mutex>
+
+#include <stdlib.h>
+
+/*
+ * Throughput of page sized allocations from several threads: the lock-free buddy
+ * allocator against the sequential one guarded by a single mutex.
+ */
+
+namespace {
+
+constexpr uintptr_t areaSize = 64 << 20;
+constexpr int nOps = 200000;
+constexpr int window = 16;
+
+template<class Allocate, class Free>
+double measure(int nThreads, Allocate &&allocate, Free &&release)
+{
+    return bench::secondsParallel(nThreads, [&](int)
+    {
+        void* live[window] = {};
+
+        for(int i = 0; i < nOps; i++)
+        {
+            auto &slot = live[i % window];
+
+            if(slot)
+                release(slot);
+
+            slot = allocate((i % 3 + 1) * 4096);
+        }
+
+        for(auto p: live)
+            if(p)
+                release(p);
+    });
+}
+
+}
+
+TEST_GROUP(ConcurrentBuddyBench) {};
+
+TEST(ConcurrentBuddyBench, Throughput)
+{
+    char* const area = static_cast<char*>(aligned_alloc(4096, areaSize));
+
+    bench::title("Page allocations per second [M/s] (lock-free buddy vs. mutex guarded buddy)");
+    printf("%8s %12s %12s\n", "threads", "lock-free", "mutex");
+
+    for(int nThreads: {1, 2, 4, 8})
+    {
+        pet::ConcurrentBuddyAllocator<12, 12> lockFree;
+        CHECK(lockFree.init(area, area + areaSize));
+
+        const double tLockFree = measure(nThreads,
+            [&](uint32_t size) { return lockFree.allocate(size); },
+            [&](void* ptr) { lockFree.free(ptr); });
+
+        pet::BuddyAllocator<12, 12> sequential;
+        std::mutex mutex;
+        CHECK(sequential.init(area, area + areaSize));
+
+        const double tMutex = measure(nThreads,
+            [&](uint32_t size) { std::lock_guard<std::mutex> l(mutex); return sequential.allocate(size); },
+            [&](void* ptr) { std::lock_guard<std::mutex> l(mutex); sequential.free(ptr); });
+
+        const double nTotal = 2.0 * nOps * nThreads / 1e6;
+        printf("%8d %12.2f %12.2f\n", nThreads, nTotal / tLockFree, nTotal / tMutex);
+    }
+
+    free(area);
+}
@@ -0,0 +1,63 @@
+/*******************************************************************************
+ *
+ * Copyright (c) 2026 Tamás Seller. All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *******************************************************************************/
+
+#include "1test/Test.h"
+
+#include "Bench.h"
+#include "Workload.h"
+
+#include "heap/AvlTreePolicy.h"
+#include "heap/BestFitPolicy.h"
+
+/*
+ * Fragmentation of the address-ordered best-fit mode of the AVL tree policy
+ * against the default mode, the TLSF and the list based best-fit policies.
+ */
+
+namespace {
+
+constexpr uintptr_t areaSize = 64 << 20;
+
+}
+
+TEST_GROUP(FragmentationBench) {};
+
+TEST(FragmentationBench, AddressOrdered)
+{
+    bench::title("Fragmentation of long running workloads (times in ns, fragmentation in permille)");
+
+    const struct { const char* name; bench::Workload workload; } cases[] =
+    {
+        {"small blocks", {300000, 3000, 8, 512, 0, 11}},
+        {"mixed blocks with resizes", {300000, 2000, 16, 8192, 100, 12}},
+        {"wide size range", {100000, 1000, 8, 65536, 0, 13}},
+    };
+
+    for(const auto &c: cases)
+    {
+        const auto trace = bench::synthesize(c.workload);
+
+        printf("\n%s\n", c.name);
+        bench::replayHeader();
+        bench::replayHeap<pet::AvlHeap<uint32_t, 3, false, false, true>>("avl-address-ordered", trace, areaSize);
+        bench::replayHeap<pet::AvlHeap<uint32_t, 3>>("avl", trace, areaSize);
+        bench::replayHeap<pet::TlsfHeap<uint32_t, 3, false, false, 24>>("tlsf", trace, areaSize);
+        bench::replayHeap<pet::BestFitHeap<uint32_t, 3>>("best-fit", trace, areaSize);
+    }
+}
@@ -0,0 +1,99 @@
+/*******************************************************************************
+ *
+ * Copyright (c) 2026 Tamás Seller. All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *******************************************************************************/
+
+#include "1test/Test.h"
+
+#include "Bench.h"
+
+#include "heap/GrowingHeap.h"
+#include "heap/TlsfPolicy.h"
+#include "platform/linux/MmapProvider.h"
+#include "platform/linux/HugePageProvider.h"
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+/*
+ * The gain of backing a growing heap with huge pages: the time taken by populating
+ * the heap (page faults) and by random accesses to the blocks (TLB misses).
+ */
+
+namespace {
+
+constexpr int nBlocks = 400000;
+constexpr int nHops = 10000000;
+
+struct Node
+{
+    Node* next;
+};
+
+template<class Provider>
+void measure(const char* name)
+{
+    pet::GrowingHeap<pet::TlsfHeap<uint32_t, 3, false, false, 24>, Provider, 32 << 20> heap;
+    std::vector<Node*> nodes(nBlocks);
+    std::minstd_rand rng(7);
+
+    const double tPopulate = bench::seconds([&]()
+    {
+        for(auto &n: nodes)
+        {
+            n = static_cast<Node*>(heap.alloc(64 + rng() % 448));
+            n->next = nullptr;
+        }
+    });
+
+    std::shuffle(nodes.begin(), nodes.end(), rng);
+
+    for(int i = 0; i < nBlocks; i++)
+        nodes[i]->next = nodes[(i + 1) % nBlocks];
+
+    Node* volatile last;
+
+    const double tChase = bench::seconds([&]()
+    {
+        Node* n = nodes[0];
+
+        for(int i = 0; i < nHops; i++)
+            n = n->next;
+
+        last = n;
+    });
+
+    (void)last;
+
+    for(auto n: nodes)
+        heap.free(n);
+
+    printf("%-12s %14.1f %14.1f\n", name, tPopulate * 1e9 / nBlocks, tChase * 1e9 / nHops);
+}
+
+}
+
+TEST_GROUP(HugePageBench) {};
+
+TEST(HugePageBench, RandomAccess)
+{
+    bench::title("Growing heap on regular and huge pages (ns per allocation and per random access)");
+    printf("%-12s %14s %14s\n", "pages", "populate", "access");
+    measure<pet::MmapProvider>("regular");
+    measure<pet::HugePageProvider>("huge");
+}
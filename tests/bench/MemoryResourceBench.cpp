@@ -0,0 +1,177 @@
+/*******************************************************************************
+ *
+ * Copyright (c) 2026 Tamás Seller. All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *******************************************************************************/
+
+#include "1test/Test.h"
+
+#include "Bench.h"
+
+#include "heap/MemoryResource.h"
+#include "heap/TlsfPolicy.h"
+#include "heap/Buddy.h"
+
+#include <memory_resource>
+#include <mutex>
+#include <random>
+#include <map>
+#include <string>
+#include <vector>
+
+#include <stdlib.h>
+
+/*
+ * The memory resource adapters against the default std::pmr::new_delete_resource(),
+ * on workloads of the std::pmr containers. The same operations are executed with each
+ * resource, the checksum of the container contents guards against differences.
+ */
+
+namespace {
+
+using Tlsf = pet::TlsfHeap<uint32_t, 3, false, false, 24>;
+using Buddy = pet::BuddyAllocator<4, 12>;
+
+constexpr uintptr_t areaSize = 64 << 20;
+constexpr uint32_t nOps = 500000;
+
+/*
+ * Inserts strings of random length (beyond the small string buffer) into a map and
+ * erases random entries, keeping the map around a few thousand entries.
+ */
+uint64_t mapOfStrings(std::pmr::memory_resource* resource)
+{
+    std::pmr::map<uint32_t, std::pmr::string> map(resource);
+    std::minstd_rand rng(1);
+    uint64_t sum = 0;
+
+    for(uint32_t i = 0; i < nOps; i++)
+    {
+        const uint32_t key = rng() % 8192;
+
+        if(rng() % 2)
+        {
+            map.insert_or_assign(key, std::pmr::string(32 + rng() % 256, char('a' + key % 26), resource));
+        }
+        else
+        {
+            auto it = map.find(key);
+
+            if(it != map.end())
+            {
+                sum += it->second.size();
+                map.erase(it);
+            }
+        }
+    }
+
+    for(auto &e: map)
+        sum += e.first + e.second.size();
+
+    return sum;
+}
+
+/*
+ * Grows vectors by appending to them one by one (exercising the reallocation
+ * pattern of the containers), and drops a random one when there are too many.
+ */
+uint64_t growingVectors(std::pmr::memory_resource* resource)
+{
+    std::pmr::vector<std::pmr::vector<uint32_t>> vectors(resource);
+    std::minstd_rand rng(2);
+    uint64_t sum = 0;
+
+    for(uint32_t i = 0; i < nOps; i++)
+    {
+        if(vectors.size() < 256)
+            vectors.emplace_back();
+
+        auto &v = vectors[rng() % vectors.size()];
+        v.push_back(i);
+
+        if(v.size() > 1024 || rng() % 512 == 0)
+        {
+            sum += v.size();
+            v = std::pmr::vector<uint32_t>(resource);
+        }
+    }
+
+    for(auto &v: vectors)
+        sum += v.size();
+
+    return sum;
+}
+
+/*
+ * Runs a workload with a resource and prints a row of the table.
+ */
+template<class Workload>
+uint64_t run(const char* name, Workload &&workload, std::pmr::memory_resource* resource)
+{
+    uint64_t sum = 0;
+    const double t = bench::seconds([&](){ sum = workload(resource); });
+    printf("%-24s %10.1f\n", name, t * 1e9 / nOps);
+    return sum;
+}
+
+template<class Workload>
+void compare(Workload &&workload)
+{
+    printf("%-24s %10s\n", "resource", "ns/op");
+
+    const auto expected = run("new-delete", workload, std::pmr::new_delete_resource());
+
+    {
+        char* const area = static_cast<char*>(aligned_alloc(4096, areaSize));
+        Tlsf heap(area, areaSize);
+        pet::HeapMemoryResource<Tlsf> resource(heap);
+        CHECK(run("tlsf", workload, &resource) == expected);
+        CHECK(heap.getStats(area).nUsed == 0);
+        free(area);
+    }
+
+    {
+        char* const area = static_cast<char*>(aligned_alloc(4096, areaSize));
+        Tlsf heap(area, areaSize);
+        pet::HeapMemoryResource<Tlsf, std::mutex> resource(heap);
+        CHECK(run("tlsf-locked", workload, &resource) == expected);
+        free(area);
+    }
+
+    {
+        char* const area = static_cast<char*>(aligned_alloc(4096, areaSize));
+        Buddy buddy;
+        CHECK(buddy.init(area, area + areaSize));
+        pet::BuddyMemoryResource<Buddy> resource(buddy);
+        CHECK(run("buddy", workload, &resource) == expected);
+        free(area);
+    }
+}
+
+}
+
+TEST_GROUP(MemoryResourceBench) {};
+
+TEST(MemoryResourceBench, Containers)
+{
+    bench::title("Memory resources under std::pmr containers (times in ns per operation)");
+
+    printf("\nmap of strings\n");
+    compare(mapOfStrings);
+
+    printf("\ngrowing vectors\n");
+    compare(growingVectors);
+}
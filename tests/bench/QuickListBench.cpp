@@ -0,0 +1,61 @@
+/*******************************************************************************
+ *
+ * Copyright (c) 2026 Tamás Seller. All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *******************************************************************************/
+
+#include "1test/Test.h"
+
+#include "Bench.h"
+#include "Workload.h"
+
+#include "heap/QuickListHeap.h"
+
+/*
+ * The quick list front-end against the plain TLSF heap, on workloads of small
+ * objects of a few sizes, and with some larger blocks mixed in.
+ */
+
+namespace {
+
+using Tlsf = pet::TlsfHeap<uint32_t, 3, false, false, 24>;
+
+constexpr uintptr_t areaSize = 64 << 20;
+
+void compare(const bench::Trace &trace)
+{
+    bench::replayHeader();
+    bench::replayHeap<Tlsf>("tlsf", trace, areaSize);
+    bench::replayHeap<pet::QuickListHeap<Tlsf>>("quick-list", trace, areaSize);
+}
+
+}
+
+TEST_GROUP(QuickListBench) {};
+
+TEST(QuickListBench, SmallObjects)
+{
+    bench::title("Quick lists on small objects (times in ns, fragmentation in permille)");
+
+    for(uint32_t nLive: {100, 1000, 10000})
+    {
+        printf("\n%u live blocks of 8..128 bytes\n", nLive);
+        compare(bench::synthesize({500000, nLive, 8, 128, 0, nLive}));
+    }
+
+    printf("\n1000 live blocks of 8..4096 bytes\n");
+    compare(bench::synthesize({500000, 1000, 8, 4096, 0, 1}));
+}
@@ -0,0 +1,69 @@
+/*******************************************************************************
+ *
+ * Copyright (c) 2026 Tamás Seller. All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *******************************************************************************/
+
+#include "1test/Test.h"
+
+#include "Bench.h"
+#include "Workload.h"
+
+#include "heap/AvlTreePolicy.h"
+#include "heap/BestFitPolicy.h"
+#include "heap/SegregatedFitPolicy.h"
+#include "heap/Buddy.h"
+
+#include <stdlib.h>
+
+/*
+ * Replays an allocation trace against each heap policy and the buddy allocator.
+ *
+ * The trace recorded by an application can be provided in the file named by the
+ * PET_ALLOC_TRACE environment variable, otherwise a synthetic one is used.
+ */
+
+namespace {
+
+constexpr uintptr_t areaSize = 64 << 20;
+
+}
+
+TEST_GROUP(ReplayBench) {};
+
+TEST(ReplayBench, Policies)
+{
+    bench::Trace trace;
+
+    if(!bench::load("PET_ALLOC_TRACE", trace))
+        trace = bench::synthesize({200000, 2000, 16, 4096, 50, 1});
+
+    bench::title("Trace replay against each policy (times in ns, fragmentation in permille)");
+    bench::replayHeader();
+
+    bench::replayHeap<pet::TlsfHeap<uint32_t, 3, false, false, 24>>("tlsf", trace, areaSize);
+    bench::replayHeap<pet::AvlHeap<uint32_t, 3>>("avl", trace, areaSize);
+    bench::replayHeap<pet::AvlHeap<uint32_t, 3, false, false, true>>("avl-address-ordered", trace, areaSize);
+    bench::replayHeap<pet::BestFitHeap<uint32_t, 3>>("best-fit", trace, areaSize);
+    bench::replayHeap<pet::SegregatedFitHeap<uint32_t, 3>>("segregated-fit", trace, areaSize);
+
+    char* const area = static_cast<char*>(aligned_alloc(4096, areaSize));
+    pet::BuddyAllocator<4, 12> buddy;
+    CHECK(buddy.init(area, area + areaSize));
+    pet::BuddyReplayAdapter<decltype(buddy)> adapter{buddy};
+    bench::replay("buddy", trace, adapter);
+    free(area);
+}
@@ -0,0 +1,54 @@
+/*******************************************************************************
+ *
+ * Copyright (c) 2026 Tamás Seller. All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *******************************************************************************/
+
+#include "1test/Test.h"
+
+#include "Bench.h"
+#include "Workload.h"
+
+#include "heap/BestFitPolicy.h"
+#include "heap/SegregatedFitPolicy.h"
+
+/*
+ * The segregated fit policy against the list based best-fit one, with the number
+ * of live blocks (and along with it the length of the free list) growing.
+ */
+
+namespace {
+
+constexpr uintptr_t areaSize = 64 << 20;
+
+}
+
+TEST_GROUP(SegregatedFitBench) {};
+
+TEST(SegregatedFitBench, FreeListLength)
+{
+    bench::title("Segregated fit against best-fit with growing free lists (times in ns, fragmentation in permille)");
+
+    for(uint32_t nLive: {250, 1000, 4000, 16000})
+    {
+        const auto trace = bench::synthesize({100000, nLive, 8, 1024, 0, nLive});
+
+        printf("\n%u live blocks\n", nLive);
+        bench::replayHeader();
+        bench::replayHeap<pet::SegregatedFitHeap<uint32_t, 3>>("segregated-fit", trace, areaSize);
+        bench::replayHeap<pet::BestFitHeap<uint32_t, 3>>("best-fit", trace, areaSize);
+    }
+}
@@ -0,0 +1,115 @@
+/*******************************************************************************
+ *
+ * Copyright (c) 2026 Tamás Seller. All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *******************************************************************************/
+
+#include "1test/Test.h"
+
+#include "Bench.h"
+
+#include "heap/ShardedHeap.h"
+#include "heap/TlsfPolicy.h"
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+
+/*
+ * Throughput of small allocations from several threads with a growing number of
+ * arenas (one arena being the same as a single heap behind a lock), along with
+ * the ratio of the lock acquisitions that found the lock held by another thread.
+ */
+
+namespace {
+
+constexpr uintptr_t areaSize = 64 << 20;
+constexpr int nOps = 200000;
+constexpr int window = 64;
+
+/// Mutex that counts the acquisitions that had to wait.
+struct CountingMutex
+{
+    static inline std::atomic<unsigned long> nLocks, nContended;
+    std::mutex mutex;
+
+    inline void lock()
+    {
+        nLocks.fetch_add(1, std::memory_order_relaxed);
+
+        if(!mutex.try_lock())
+        {
+            nContended.fetch_add(1, std::memory_order_relaxed);
+            mutex.lock();
+        }
+    }
+
+    inline void unlock() {
+        mutex.unlock();
+    }
+};
+
+using Arena = pet::TlsfHeap<uint32_t, 3, false, false, 24>;
+
+template<unsigned int nArenas>
+void measure(char* area, int nThreads)
+{
+    std::unique_ptr<pet::ShardedHeap<Arena, CountingMutex, nArenas>> heap(new pet::ShardedHeap<Arena, CountingMutex, nArenas>);
+    heap->init(area, areaSize);
+    CountingMutex::nLocks = CountingMutex::nContended = 0;
+
+    const double t = bench::secondsParallel(nThreads, [&](int)
+    {
+        void* live[window] = {};
+
+        for(int i = 0; i < nOps; i++)
+        {
+            auto &slot = live[i % window];
+
+            if(slot)
+                heap->free(slot);
+
+            slot = heap->alloc(16 + (i * 7 % 32) * 8);
+        }
+
+        for(auto p: live)
+            if(p)
+                heap->free(p);
+    });
+
+    printf("%8d %8u %12.2f %12.2f\n", nThreads, nArenas, 2.0 * nOps * nThreads / 1e6 / t,
+            100.0 * CountingMutex::nContended / CountingMutex::nLocks);
+}
+
+}
+
+TEST_GROUP(ShardedHeapBench) {};
+
+TEST(ShardedHeapBench, Contention)
+{
+    std::unique_ptr<char[]> area(new char[areaSize]);
+
+    bench::title("Small allocations per second [M/s] and contended lock acquisitions [%] by the number of arenas");
+    printf("%8s %8s %12s %12s\n", "threads", "arenas", "rate", "contended");
+
+    for(int nThreads: {1, 2, 4, 8})
+    {
+        measure<1>(area.get(), nThreads);
+        measure<2>(area.get(), nThreads);
+        measure<4>(area.get(), nThreads);
+        measure<8>(area.get(), nThreads);
+    }
+}
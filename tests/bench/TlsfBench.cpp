@@ -0,0 +1,71 @@
+/*******************************************************************************
+ *
+ * Copyright (c) 2026 Tamás Seller. All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *******************************************************************************/
+
+#include "1test/Test.h"
+
+#include "Bench.h"
+#include "Workload.h"
+
+/*
+ * The trade-off of the second level bucket count of the TLSF policy: more buckets
+ * means closer fits (less fragmentation) at the cost of a larger index.
+ */
+
+namespace {
+
+constexpr uintptr_t areaSize = 64 << 20;
+
+template<unsigned int slCount>
+void measure(const bench::Trace &trace)
+{
+    using Heap = pet::TlsfHeap<uint32_t, 3, false, false, 24, slCount>;
+
+    char name[32];
+    snprintf(name, sizeof(name), "tlsf sl=%u (%u B)", slCount, (unsigned int)sizeof(Heap));
+    bench::replayHeap<Heap>(name, trace, areaSize);
+}
+
+}
+
+TEST_GROUP(TlsfBench) {};
+
+TEST(TlsfBench, SecondLevelCount)
+{
+    bench::title("TLSF second level bucket count (times in ns, fragmentation in permille, index size in brackets)");
+
+    const struct { const char* name; bench::Workload workload; } cases[] =
+    {
+        {"small blocks", {200000, 4000, 8, 256, 0, 1}},
+        {"mixed blocks", {200000, 2000, 16, 4096, 50, 2}},
+        {"large blocks", {50000, 500, 1024, 65536, 50, 3}},
+    };
+
+    for(const auto &c: cases)
+    {
+        const auto trace = bench::synthesize(c.workload);
+
+        printf("\n%s\n", c.name);
+        bench::replayHeader();
+        measure<4>(trace);
+        measure<8>(trace);
+        measure<16>(trace);
+        measure<32>(trace);
+        measure<64>(trace);
+    }
+}
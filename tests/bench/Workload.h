@@ -0,0 +1,183 @@
+/*******************************************************************************
+ *
+ * Copyright (c) 2026 Tamás Seller. All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *******************************************************************************/
+
+#ifndef PET_TESTS_BENCH_WORKLOAD_H_
+#define PET_TESTS_BENCH_WORKLOAD_H_
+
+#include "heap/TlsfPolicy.h"
+#include "heap/AllocTrace.h"
+#include "heap/AllocReplay.h"
+
+#include <chrono>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+
+/*
+ * Allocation workloads for the benchmarks: synthetic traces recorded with the
+ * AllocTraceRecorder (or loaded from a file), that are replayed by AllocReplay
+ * against the allocators under test.
+ */
+namespace bench {
+
+/// Nanosecond clock for the trace recorder and the replay.
+struct NanoClock
+{
+    static inline uint32_t now() {
+        return (uint32_t)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+};
+
+/// Encoded allocation trace in memory (the sink of the recorder).
+struct Trace
+{
+    std::vector<uint8_t> data;
+
+    inline void write(const uint8_t* bytes, uint32_t length) {
+        data.insert(data.end(), bytes, bytes + length);
+    }
+
+    inline pet::AllocTraceReader reader() const {
+        return pet::AllocTraceReader(data.data(), data.size());
+    }
+};
+
+/// Parameters of a synthetic workload.
+struct Workload
+{
+    uint32_t nOps;              //!< The number of allocations.
+    uint32_t maxLive;           //!< The number of blocks kept live (after ramping up).
+    uint32_t minSize, maxSize;  //!< The range of the requested sizes (log-uniform distribution).
+    uint32_t resizePermille;    //!< The ratio of resizes to allocations, in permille.
+    uint32_t seed;
+};
+
+/**
+ * Record a synthetic trace.
+ *
+ * Allocates blocks of random size, releasing a randomly selected one whenever the
+ * number of live blocks reaches the limit (so that the lifetimes are mixed).
+ */
+inline Trace synthesize(const Workload &w)
+{
+    using Heap = pet::TlsfHeap<uint32_t, 3, false, false, 24>;
+    constexpr uintptr_t areaSize = 256 << 20;
+
+    std::unique_ptr<char[]> area(new char[areaSize]);
+    Heap heap(area.get(), areaSize);
+    Trace ret;
+    pet::AllocTraceRecorder<Heap, NanoClock, Trace> recorder(heap, ret, area.get());
+
+    std::minstd_rand rng(w.seed);
+    std::uniform_real_distribution<double> logSize(log(w.minSize), log(w.maxSize + 1));
+    std::vector<void*> live;
+
+    for(uint32_t i = 0; i < w.nOps; i++)
+    {
+        if(live.size() >= w.maxLive)
+        {
+            const auto idx = rng() % live.size();
+            recorder.free(live[idx]);
+            live[idx] = live.back();
+            live.pop_back();
+        }
+
+        if(void* ptr = recorder.alloc((uintptr_t)exp(logSize(rng))))
+            live.push_back(ptr);
+
+        if(!live.empty() && rng() % 1000 < w.resizePermille)
+            recorder.resize(live[rng() % live.size()], (uintptr_t)exp(logSize(rng)));
+    }
+
+    for(auto ptr: live)
+        recorder.free(ptr);
+
+    return ret;
+}
+
+/**
+ * Load a trace recorded by the application, if the named environment variable is set.
+ */
+inline bool load(const char* variable, Trace &trace)
+{
+    const char* path = getenv(variable);
+
+    if(!path)
+        return false;
+
+    FILE* f = fopen(path, "rb");
+
+    if(!f)
+        return false;
+
+    uint8_t buffer[4096];
+
+    while(const auto n = fread(buffer, 1, sizeof(buffer), f))
+        trace.write(buffer, n);
+
+    fclose(f);
+    return true;
+}
+
+/// Replayer with room for the live blocks of the workloads.
+using Replay = pet::AllocReplay<NanoClock, 1 << 16>;
+
+/**
+ * Replay the trace against an allocator and print the results as a row of a table.
+ */
+template<class Allocator>
+inline pet::AllocReplayReport replay(const char* name, const Trace &trace, Allocator &allocator)
+{
+    std::unique_ptr<Replay> replay(new Replay);
+    std::unique_ptr<pet::LatencyHistogram> histogram(new pet::LatencyHistogram);
+    const auto r = replay->run(allocator, trace.reader(), *histogram);
+
+    printf("%-24s %9u %7u %8.1f %6u %6u %7u %9lu %6u\n", name, r.nOps, r.nFailed,
+            r.nOps ? (double)r.totalTime / r.nOps : 0.0, r.p50, r.p99, r.p999,
+            (unsigned long)(r.peakFootprint >> 10), r.fragmentation);
+
+    return r;
+}
+
+/// Print the header of the table of the replay results.
+inline void replayHeader()
+{
+    printf("%-24s %9s %7s %8s %6s %6s %7s %9s %6s\n", "allocator", "ops", "failed",
+            "ns/op", "p50", "p99", "p99.9", "peak[KB]", "frag");
+}
+
+/**
+ * Replay the trace against a heap, that is created over an area of the given size.
+ */
+template<class Heap>
+inline pet::AllocReplayReport replayHeap(const char* name, const Trace &trace, uintptr_t areaSize)
+{
+    std::unique_ptr<char[]> area(new char[areaSize + 64]);
+    const auto start = reinterpret_cast<char*>((reinterpret_cast<uintptr_t>(area.get()) + 63) & ~uintptr_t(63));
+    Heap heap(start, areaSize);
+    return replay(name, trace, heap);
+}
+
+}
+
+#endif /* PET_TESTS_BENCH_WORKLOAD_H_ */
@@ -0,0 +1,126 @@
+/*******************************************************************************
+ *
+ * Copyright (c) 2026 Tamás Seller. All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *******************************************************************************/
+
+#include "1test/Test.h"
+
+#include "heap/TlsfPolicy.h"
+#include "heap/AvlTreePolicy.h"
+#include "heap/BestFitPolicy.h"
+#include "heap/MemoryResource.h"
+
+#include <vector>
+#include <random>
+
+namespace {
+
+alignas(16) char area[1 << 17];
+
+/*
+ * Allocates blocks of every small size (up to beyond the free block header size of
+ * any policy) with larger than natural alignments, between a varying number of other
+ * blocks, so that the allocations start at all kinds of offsets.
+ */
+template<class Heap>
+bool alignedSmallBlocks()
+{
+    Heap heap(area, sizeof(area));
+    std::vector<void*> fillers;
+    std::minstd_rand rng(5);
+
+    for(uintptr_t align = 2 * Heap::alignment; align <= 4096; align *= 2)
+    {
+        for(uintptr_t size = 0; size <= 64; size++)
+        {
+            for(int i = 0; i < 8; i++)
+            {
+                if(void* filler = heap.alloc(rng() % 64 + 1))
+                    fillers.push_back(filler);
+
+                void* ptr = heap.allocAligned(size, align);
+
+                if(!ptr || (uintptr_t)ptr % align || Heap::getSize(ptr) < size)
+                    return false;
+
+                heap.free(ptr);
+            }
+
+            for(auto filler: fillers)
+                heap.free(filler);
+
+            fillers.clear();
+        }
+    }
+
+    return heap.getStats(area).nUsed == 0;
+}
+
+template<class Heap>
+bool hugeRequestsRejected()
+{
+    Heap heap(area, sizeof(area));
+    const uintptr_t huge = uintptr_t(1) << (sizeof(uintptr_t) * 8 - 4);
+
+    return !heap.allocAligned(uintptr_t(-1) - huge + 1, huge)
+        && !heap.allocAligned(uintptr_t(-1), 64)
+        && !heap.allocAligned(16, huge)
+        && !heap.allocAligned(sizeof(area), 64)
+        && heap.allocAligned(1024, 64);
+}
+
+}
+
+TEST_GROUP(AllocAligned) {};
+
+TEST(AllocAligned, Tlsf)
+{
+    CHECK(alignedSmallBlocks<pet::TlsfHeap<uint32_t, 3>>());
+    CHECK(alignedSmallBlocks<pet::TlsfHeap<uint32_t, 3, true>>());
+    CHECK(alignedSmallBlocks<pet::TlsfHeap<uint32_t, 4, true, true>>());
+    CHECK(hugeRequestsRejected<pet::TlsfHeap<uint32_t, 3>>());
+}
+
+TEST(AllocAligned, Avl)
+{
+    CHECK(alignedSmallBlocks<pet::AvlHeap<uint32_t, 3>>());
+    CHECK(alignedSmallBlocks<pet::AvlHeap<uint32_t, 3, true>>());
+    CHECK(hugeRequestsRejected<pet::AvlHeap<uint32_t, 3>>());
+}
+
+TEST(AllocAligned, BestFit)
+{
+    CHECK(alignedSmallBlocks<pet::BestFitHeap<uint32_t, 3>>());
+    CHECK(alignedSmallBlocks<pet::BestFitHeap<uint16_t, 3, true>>());
+    CHECK(hugeRequestsRejected<pet::BestFitHeap<uint16_t, 3>>());
+}
+
+TEST(AllocAligned, MemoryResource)
+{
+    pet::TlsfHeap<uint32_t, 3> heap(area, sizeof(area));
+    pet::HeapMemoryResource<decltype(heap)> resource(heap);
+
+    for(size_t align = 16; align <= 256; align *= 2)
+    {
+        for(size_t size = 1; size <= 64; size++)
+        {
+            void* ptr = resource.allocate(size, align);
+            CHECK((uintptr_t)ptr % align == 0);
+            resource.deallocate(ptr, size, align);
+        }
+    }
+}
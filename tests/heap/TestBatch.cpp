@@ -0,0 +1,227 @@
+/*******************************************************************************
+ *
+ * Copyright (c) 2026 Tamás Seller. All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *******************************************************************************/
+
+#include "1test/Test.h"
+
+#include "heap/TlsfPolicy.h"
+#include "heap/AvlTreePolicy.h"
+#include "heap/BestFitPolicy.h"
+#include "heap/SegregatedFitPolicy.h"
+
+#include <algorithm>
+#include <random>
+
+namespace {
+
+alignas(16) char area[1 << 16];
+
+/*
+ * Checks the blocks returned by allocBatch: distinct, large enough and not overlapping.
+ */
+template<class Heap>
+bool validBatch(void** out, unsigned int n, uintptr_t size)
+{
+    void* sorted[256];
+    std::copy(out, out + n, sorted);
+    std::sort(sorted, sorted + n);
+
+    for(auto i = 0u; i < n; i++)
+    {
+        if(Heap::isFree(sorted[i]) || Heap::getSize(sorted[i]) < size)
+            return false;
+
+        if(i && (char*)sorted[i - 1] + Heap::getSize(sorted[i - 1]) > (char*)sorted[i])
+            return false;
+    }
+
+    return true;
+}
+
+template<class Heap>
+bool statsConsistent(Heap &heap)
+{
+    const auto tracked = heap.getStats();
+    const auto walked = heap.getStats(area);
+
+    return tracked.longestFree == walked.longestFree && tracked.totalFree == walked.totalFree
+            && tracked.nUsed == walked.nUsed && tracked.totalUsed == walked.totalUsed;
+}
+
+/*
+ * A batch from a single free block is a run of adjacent blocks in ascending order.
+ */
+template<class Heap>
+bool adjacentBatch(bool hot)
+{
+    Heap heap(area, sizeof(area));
+    const auto initial = heap.getStats();
+
+    void* out[32];
+    const uintptr_t size = 40;
+
+    if(heap.allocBatch(size, 32, out, hot) != 32 || !validBatch<Heap>(out, 32, size))
+        return false;
+
+    for(auto i = 0u; i + 1 < 32; i++)
+    {
+        if(heap.nextBlock(out[i]) != out[i + 1])
+            return false;
+    }
+
+    if(heap.getStats().nUsed != 32 || !statsConsistent(heap))
+        return false;
+
+    heap.freeBatch(out, 32);
+
+    const auto final = heap.getStats();
+    return final.nUsed == 0 && final.longestFree == initial.longestFree && statsConsistent(heap);
+}
+
+/*
+ * If no single free block is large enough, the blocks are allocated one by one, and the
+ * count is short only if the heap is exhausted, in which case the ones allocated are valid.
+ */
+template<class Heap>
+bool partialBatch()
+{
+    Heap heap(area, sizeof(area));
+    const auto initial = heap.getStats();
+
+    if(heap.allocBatch(uintptr_t(-1) / 2, 4, nullptr) != 0 || heap.allocBatch(16, 0, nullptr) != 0)
+        return false;
+
+    // Fragment the heap, so that only small holes remain.
+    void* blocks[512];
+    auto nBlocks = 0u;
+
+    while(nBlocks < 512 && (blocks[nBlocks] = heap.alloc(200)))
+        nBlocks++;
+
+    for(auto i = 0u; i < nBlocks; i += 2)
+        heap.free(blocks[i]);
+
+    if(heap.getStats().longestFree >= 2 * Heap::usableSize(200))
+        return false;
+
+    // Fits into the holes, but not into any single one of them.
+    void* out[256];
+    const auto nHoles = (nBlocks + 1) / 2;
+
+    if(heap.allocBatch(150, 4, out) != 4 || !validBatch<Heap>(out, 4, 150))
+        return false;
+
+    // Asks for more than what is left.
+    const auto got = heap.allocBatch(150, 256, out + 4);
+
+    if(got < nHoles - 4 || got >= 256 || !validBatch<Heap>(out, 4 + got, 150) || heap.alloc(150))
+        return false;
+
+    if(heap.getStats().nUsed != nBlocks / 2 + 4 + got || !statsConsistent(heap))
+        return false;
+
+    heap.freeBatch(out, 4 + got);
+
+    for(auto i = 1u; i < nBlocks; i += 2)
+        heap.free(blocks[i]);
+
+    const auto final = heap.getStats();
+    return final.nUsed == 0 && final.longestFree == initial.longestFree && statsConsistent(heap);
+}
+
+/*
+ * The runs of adjacent blocks released together end up in single free blocks, merged
+ * with the free neighbors, irrespective of the order of the pointers.
+ */
+template<class Heap>
+bool batchMerges()
+{
+    Heap heap(area, sizeof(area));
+
+    void* blocks[20];
+
+    for(auto &b: blocks)
+        b = heap.alloc(64, true);
+
+    std::sort(blocks, blocks + 20);
+
+    for(auto i = 0u; i + 1 < 20; i++)
+    {
+        if(heap.nextBlock(blocks[i]) != blocks[i + 1])
+            return false;
+    }
+
+    heap.free(blocks[2]);
+
+    void* batch[] = {blocks[7], blocks[14], blocks[4], blocks[3], blocks[8], blocks[12], blocks[6], blocks[5], blocks[17], blocks[16]};
+    const auto n = sizeof(batch) / sizeof(batch[0]);
+    std::minstd_rand rng(1);
+    std::shuffle(batch, batch + n, rng);
+
+    heap.freeBatch(batch, n);
+
+    // The array is sorted in place.
+    if(!std::is_sorted(batch, batch + n))
+        return false;
+
+    // 2-8 merged into one block, 12 and 14 are alone, 16-17 merged.
+    const void* expected[][2] = {{blocks[2], blocks[9]}, {blocks[12], blocks[13]}, {blocks[14], blocks[15]}, {blocks[16], blocks[18]}};
+
+    for(auto &e: expected)
+    {
+        if(!Heap::isFree(const_cast<void*>(e[0])) || heap.nextBlock(const_cast<void*>(e[0])) != e[1])
+            return false;
+    }
+
+    for(auto i: {0, 1, 9, 10, 11, 13, 15, 18, 19})
+    {
+        if(Heap::isFree(blocks[i]))
+            return false;
+    }
+
+    return heap.getStats().nUsed == 20 - 11 && statsConsistent(heap);
+}
+
+}
+
+TEST_GROUP(Batch) {};
+
+TEST(Batch, Adjacent)
+{
+    CHECK(adjacentBatch<pet::TlsfHeap<uint32_t, 3, true, true>>(false));
+    CHECK(adjacentBatch<pet::TlsfHeap<uint32_t, 3, true, true>>(true));
+    CHECK(adjacentBatch<pet::AvlHeap<uint32_t, 3, false, true>>(false));
+    CHECK(adjacentBatch<pet::BestFitHeap<uint16_t, 4, true, true>>(true));
+    CHECK(adjacentBatch<pet::SegregatedFitHeap<uint32_t, 3, false, true>>(false));
+}
+
+TEST(Batch, PartialFailure)
+{
+    CHECK(partialBatch<pet::TlsfHeap<uint32_t, 3, true, true>>());
+    CHECK(partialBatch<pet::AvlHeap<uint32_t, 3, false, true>>());
+    CHECK(partialBatch<pet::BestFitHeap<uint16_t, 4, true, true>>());
+    CHECK(partialBatch<pet::SegregatedFitHeap<uint32_t, 3, false, true>>());
+}
+
+TEST(Batch, FreeMergesAdjacent)
+{
+    CHECK(batchMerges<pet::TlsfHeap<uint32_t, 3, true, true>>());
+    CHECK(batchMerges<pet::AvlHeap<uint32_t, 3, false, true>>());
+    CHECK(batchMerges<pet::BestFitHeap<uint16_t, 4, true, true>>());
+    CHECK(batchMerges<pet::SegregatedFitHeap<uint32_t, 3, false, true>>());
+}
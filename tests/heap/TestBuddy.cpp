@@ -0,0 +1,251 @@
+/*******************************************************************************
+ *
+ * Copyright (c) 2026 Tamás Seller. All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *******************************************************************************/
+
+#include "1test/Test.h"
+
+#include "heap/Buddy.h"
+
+#include <vector>
+#include <random>
+#include <string.h>
+
+namespace {
+
+constexpr uint32_t unitLog = 4;
+constexpr uint32_t nUnits = 16384;
+constexpr uintptr_t areaSize = nUnits << unitLog;
+
+alignas(4096) char area[areaSize];
+alignas(4) char tree[64 * 1024];
+
+/*
+ * Reference model of the buddy allocator: a map of the used units, searched
+ * linearly for the first (lowest) aligned run of free units that is large enough.
+ */
+class Reference
+{
+    std::vector<uint8_t> used = std::vector<uint8_t>(nUnits);
+
+    inline bool isFree(uint32_t from, uint32_t n, uint32_t skipFrom = 0, uint32_t skipN = 0) const
+    {
+        for(auto i = from; i < from + n; i++)
+            if(used[i] && (i < skipFrom || skipFrom + skipN <= i))
+                return false;
+
+        return true;
+    }
+
+    inline void mark(uint32_t from, uint32_t n, uint8_t value) {
+        memset(used.data() + from, value, n);
+    }
+
+public:
+    struct Block
+    {
+        uint32_t first, n;
+    };
+
+    static inline uint32_t units(uint32_t size)
+    {
+        uint32_t n = 1;
+
+        while((n << unitLog) < size)
+            n <<= 1;
+
+        return n;
+    }
+
+    inline bool allocate(uint32_t size, Block &b)
+    {
+        const auto n = units(size);
+
+        for(uint32_t i = 0; i + n <= nUnits; i += n)
+        {
+            if(isFree(i, n))
+            {
+                mark(i, n, 1);
+                b = {i, n};
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    inline void free(const Block &b) {
+        mark(b.first, b.n, 0);
+    }
+
+    inline bool adjust(Block &b, uint32_t size)
+    {
+        const auto n = units(size);
+
+        if(b.n < n)
+        {
+            const auto first = b.first & ~(n - 1);
+
+            if(!isFree(first, n, b.first, b.n))
+                return false;
+
+            mark(first, n, 1);
+            b = {first, n};
+        }
+        else
+        {
+            mark(b.first + n, b.n - n, 0);
+            b.n = n;
+        }
+
+        return true;
+    }
+};
+
+inline void* address(const Reference::Block &b) {
+    return area + (b.first << unitLog);
+}
+
+/*
+ * Runs random allocations, releases and in-place resizes against the allocator and
+ * the reference model, checking that they agree on every address and every result.
+ * The tree is filled with garbage beforehand, that has to be cleared by the initialization
+ * (in lazy mode only when first accessed, or optionally in the background by _initStep_).
+ */
+template<bool lazy>
+bool matchesReference(int nOps, bool initSteps)
+{
+    pet::BuddyAllocator<unitLog, unitLog, lazy> buddy;
+    const auto treeSize = buddy.minimalTreeSize(areaSize);
+
+    if(treeSize < 0 || (size_t)treeSize > sizeof(tree))
+        return false;
+
+    memset(tree, 0xa5, sizeof(tree));
+
+    if(!buddy.init(area, area + areaSize, tree, treeSize))
+        return false;
+
+    Reference reference;
+    std::vector<Reference::Block> live;
+    std::minstd_rand rng(13);
+    bool initDone = false;
+
+    for(int i = 0; i < nOps; i++)
+    {
+        const auto op = rng() % 8;
+        const uint32_t size = 2 + rng() % (1u << (rng() % 12 + 4));
+
+        if(op < 4)
+        {
+            Reference::Block b;
+            const bool expected = reference.allocate(size, b);
+            void* ptr = buddy.allocate(size);
+
+            if(expected ? ptr != address(b) : ptr != nullptr)
+                return false;
+
+            if(expected)
+                live.push_back(b);
+        }
+        else if(op < 6 && !live.empty())
+        {
+            const auto idx = rng() % live.size();
+
+            if(!buddy.free(address(live[idx])))
+                return false;
+
+            reference.free(live[idx]);
+            live[idx] = live.back();
+            live.pop_back();
+        }
+        else if(!live.empty())
+        {
+            auto &b = live[rng() % live.size()];
+            void* ptr = address(b);
+
+            if(buddy.adjust(ptr, size) != reference.adjust(b, size))
+                return false;
+        }
+
+        if(initSteps && !initDone && rng() % 64 == 0)
+        {
+            if constexpr(lazy)
+                initDone = buddy.initStep(1);
+        }
+    }
+
+    for(auto &b: live)
+        if(!buddy.free(address(b)))
+            return false;
+
+    return buddy.allocate(areaSize) == area && !buddy.allocate(2);
+}
+
+}
+
+TEST_GROUP(Buddy) {};
+
+TEST(Buddy, MatchesReference)
+{
+    CHECK(matchesReference<false>(100000, false));
+}
+
+TEST(Buddy, TreeSizeIncludesSummary)
+{
+    pet::BuddyAllocator<unitLog, unitLog> buddy;
+    const auto treeSize = buddy.minimalTreeSize(areaSize);
+    const auto nodeStatesSize = 2 * nUnits * 2 / 8;
+
+    CHECK(treeSize == 3 * nodeStatesSize);
+    CHECK(!buddy.init(area, area + areaSize, tree, nodeStatesSize));
+    CHECK(!buddy.init(area, area + areaSize, tree, treeSize - 1));
+    CHECK(buddy.init(area, area + areaSize, tree, treeSize));
+}
+
+TEST(Buddy, LazyMatchesReference)
+{
+    CHECK(matchesReference<true>(100000, false));
+}
+
+TEST(Buddy, LazyWithInitStepsMatchesReference)
+{
+    CHECK(matchesReference<true>(100000, true));
+}
+
+TEST(Buddy, InitStepCompletes)
+{
+    pet::BuddyAllocator<unitLog, unitLog, true> buddy;
+    const auto treeSize = buddy.minimalTreeSize(areaSize);
+    memset(tree, 0xa5, sizeof(tree));
+    CHECK(buddy.init(area, area + areaSize, tree, treeSize));
+
+    void* first = buddy.allocate(64);
+    CHECK(first == area);
+
+    unsigned int nSteps = 0;
+
+    while(!buddy.initStep(3))
+        nSteps++;
+
+    CHECK(0 < nSteps && nSteps < 2 * nUnits / 1024);
+    CHECK(buddy.initStep(1));
+
+    CHECK(buddy.allocate(areaSize / 2) == area + areaSize / 2);
+    CHECK(buddy.free(first));
+    CHECK(buddy.allocate(areaSize / 2) == area);
+}
@@ -0,0 +1,218 @@
+/*******************************************************************************
+ *
+ * Copyright (c) 2026 Tamás Seller. All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *******************************************************************************/
+
+#include "1test/Test.h"
+
+#include "heap/ConcurrentBuddy.h"
+
+#include <thread>
+#include <atomic>
+#include <vector>
+#include <random>
+
+#include <stdlib.h>
+
+namespace {
+
+using Allocator = pet::ConcurrentBuddyAllocator<12, 12>;
+constexpr uintptr_t blockSize = 4096;
+
+/*
+ * Each thread keeps a number of blocks allocated, the blocks are filled with a tag
+ * unique to the allocation, that is checked right before the release. Overlapping
+ * allocations (or corrupted blocks) show up as tag mismatches.
+ */
+struct Worker
+{
+    struct Entry
+    {
+        uint64_t* ptr;
+        uint32_t size;
+        uint64_t tag;
+    };
+
+    Allocator &allocator;
+    char* const start;
+    char* const end;
+    const uint32_t maxSize;
+    const int nIterations;
+    std::minstd_rand rng;
+    std::vector<Entry> live;
+    int errors = 0, nFailed = 0;
+
+    Worker(Allocator &allocator, char* start, char* end, uint32_t maxSize, int nIterations, int id):
+        allocator(allocator), start(start), end(end), maxSize(maxSize), nIterations(nIterations), rng(id + 1) {}
+
+    void fill(const Entry &e)
+    {
+        for(auto i = 0u; i < e.size / sizeof(uint64_t); i += 64)
+            e.ptr[i] = e.tag;
+    }
+
+    void release(const Entry &e)
+    {
+        for(auto i = 0u; i < e.size / sizeof(uint64_t); i += 64)
+            if(e.ptr[i] != e.tag)
+                errors++;
+
+        if(!allocator.free(e.ptr))
+            errors++;
+    }
+
+    void run(uint64_t id, unsigned int maxLive)
+    {
+        for(int i = 0; i < nIterations; i++)
+        {
+            if(!live.empty() && (live.size() >= maxLive || rng() % 2))
+            {
+                const auto idx = rng() % live.size();
+                release(live[idx]);
+                live[idx] = live.back();
+                live.pop_back();
+            }
+            else
+            {
+                uint32_t actual;
+                const uint32_t requested = rng() % maxSize + 1;
+
+                if(auto ptr = static_cast<uint64_t*>(allocator.allocate(requested, actual)))
+                {
+                    if(actual < requested || (char*)ptr < start || end < (char*)ptr + actual || (uintptr_t)ptr % blockSize)
+                        errors++;
+
+                    live.push_back(Entry{ptr, actual, id << 32 | i});
+                    fill(live.back());
+                }
+                else
+                {
+                    nFailed++;
+                }
+            }
+        }
+
+        for(const auto &e: live)
+            release(e);
+
+        live.clear();
+    }
+};
+
+/// Size of the largest power of two sized block that can be allocated.
+uint32_t largestBlock(Allocator &allocator)
+{
+    for(uint32_t size = 1u << 30; size >= blockSize; size >>= 1)
+    {
+        if(void* ptr = allocator.allocate(size))
+        {
+            allocator.free(ptr);
+            return size;
+        }
+    }
+
+    return 0;
+}
+
+int stress(uintptr_t areaSize, uint32_t maxSize, unsigned int maxLive, int nThreads, int nIterations, int &nFailed)
+{
+    char* const area = static_cast<char*>(aligned_alloc(blockSize, areaSize));
+    Allocator allocator;
+    allocator.init(area, area + areaSize);
+
+    const auto largest = largestBlock(allocator);
+
+    std::vector<Worker> workers;
+    workers.reserve(nThreads);
+
+    for(int i = 0; i < nThreads; i++)
+        workers.emplace_back(allocator, area, area + areaSize, maxSize, nIterations, i);
+
+    std::atomic<bool> go(false);
+    std::vector<std::thread> threads;
+
+    for(int i = 0; i < nThreads; i++)
+    {
+        threads.emplace_back([&, i]()
+        {
+            while(!go.load());
+            workers[i].run(i, maxLive);
+        });
+    }
+
+    go.store(true);
+
+    int errors = 0;
+    nFailed = 0;
+
+    for(int i = 0; i < nThreads; i++)
+    {
+        threads[i].join();
+        errors += workers[i].errors;
+        nFailed += workers[i].nFailed;
+    }
+
+    // Everything is released, so all the buddies must have been merged back.
+    if(largestBlock(allocator) != largest)
+        errors++;
+
+    free(area);
+    return errors;
+}
+
+}
+
+TEST_GROUP(ConcurrentBuddy) {};
+
+TEST(ConcurrentBuddy, Sequential)
+{
+    char* const area = static_cast<char*>(aligned_alloc(blockSize, 64 * blockSize));
+    Allocator allocator;
+    CHECK(allocator.init(area, area + 64 * blockSize));
+
+    void* a = allocator.allocate(blockSize);
+    void* b = allocator.allocate(blockSize);
+    void* c = allocator.allocate(2 * blockSize + 1);
+    CHECK(a && b && c);
+    CHECK(a != b && b != c && a != c);
+    CHECK((uintptr_t)c % blockSize == 0);
+    CHECK(!allocator.free(area + 1));
+
+    CHECK(allocator.free(a));
+    CHECK(allocator.free(c));
+    CHECK(allocator.free(b));
+    CHECK(!allocator.free(b));
+
+    free(area);
+}
+
+TEST(ConcurrentBuddy, StressLarge)
+{
+    int nFailed;
+    CHECK(stress(16 << 20, 16 * blockSize, 64, 4, 50000, nFailed) == 0);
+}
+
+TEST(ConcurrentBuddy, StressContended)
+{
+    /*
+     * A small area, so that the threads keep running out of space and are
+     * releasing and taking the same few buddies all the time.
+     */
+    int nFailed;
+    CHECK(stress(32 * blockSize, 4 * blockSize, 16, 8, 50000, nFailed) == 0);
+    CHECK(nFailed > 0);
+}
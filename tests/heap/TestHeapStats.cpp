@@ -0,0 +1,119 @@
+/*******************************************************************************
+ *
+ * Copyright (c) 2026 Tamás Seller. All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *******************************************************************************/
+
+#include "1test/Test.h"
+
+#include "heap/TlsfPolicy.h"
+#include "heap/AvlTreePolicy.h"
+#include "heap/BestFitPolicy.h"
+#include "heap/SegregatedFitPolicy.h"
+
+#include <vector>
+#include <random>
+
+namespace {
+
+alignas(16) char area[1 << 18];
+
+/*
+ * Runs a random workload and compares the incrementally maintained statistics
+ * with the ones obtained by walking the blocks.
+ */
+template<class Heap>
+bool statsMatch(int nOps)
+{
+    Heap heap(area, sizeof(area));
+    std::vector<void*> live;
+    std::minstd_rand rng(1);
+
+    for(int i = 0; i < nOps; i++)
+    {
+        const auto op = rng() % 7;
+
+        if(op < 2 || live.empty())
+        {
+            if(void* ptr = heap.alloc(1 + rng() % 2000, rng() % 2))
+                live.push_back(ptr);
+        }
+        else if(op < 4)
+        {
+            const auto idx = rng() % live.size();
+            heap.free(live[idx]);
+            live[idx] = live.back();
+            live.pop_back();
+        }
+        else if(op == 4)
+        {
+            heap.resize(live[rng() % live.size()], rng() % 3000);
+        }
+        else if(op == 5)
+        {
+            auto &ptr = live[rng() % live.size()];
+
+            if(void* moved = heap.reallocate(ptr, rng() % 3000 + 1))
+                ptr = moved;
+        }
+        else
+        {
+            void* batch[16];
+            const auto n = heap.allocBatch(1 + rng() % 100, 1 + rng() % 16, batch);
+
+            if(rng() % 2)
+                heap.freeBatch(batch, n);
+            else
+                live.insert(live.end(), batch, batch + n);
+        }
+
+        const auto tracked = heap.getStats();
+        const auto walked = heap.getStats(area);
+
+        if(tracked.longestFree != walked.longestFree || tracked.totalFree != walked.totalFree
+                || tracked.nUsed != walked.nUsed || tracked.totalUsed != walked.totalUsed)
+            return false;
+    }
+
+    return true;
+}
+
+}
+
+TEST_GROUP(HeapStats) {};
+
+TEST(HeapStats, Tlsf)
+{
+    CHECK(statsMatch<pet::TlsfHeap<uint32_t, 3, false, true>>(20000));
+    CHECK(statsMatch<pet::TlsfHeap<uint32_t, 3, true, true>>(20000));
+}
+
+TEST(HeapStats, Avl)
+{
+    CHECK(statsMatch<pet::AvlHeap<uint32_t, 3, false, true>>(20000));
+    CHECK(statsMatch<pet::AvlHeap<uint32_t, 3, false, true, true>>(20000));
+}
+
+TEST(HeapStats, BestFit)
+{
+    CHECK(statsMatch<pet::BestFitHeap<uint16_t, 4, true, true>>(20000));
+    CHECK(statsMatch<pet::BestFitHeap<uint32_t, 3, false, true, true>>(20000));
+}
+
+TEST(HeapStats, SegregatedFit)
+{
+    CHECK(statsMatch<pet::SegregatedFitHeap<uint32_t, 3, false, true>>(20000));
+}
@@ -0,0 +1,137 @@
+/*******************************************************************************
+ *
+ * Copyright (c) 2026 Tamás Seller. All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *******************************************************************************/
+
+#include "1test/Test.h"
+
+#include "heap/OwnedHeap.h"
+#include "heap/TlsfPolicy.h"
+#include "heap/GrowingHeap.h"
+#include "platform/linux/MmapProvider.h"
+
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <random>
+
+namespace {
+
+alignas(16) char area[1 << 20];
+
+/*
+ * The owner allocates tagged blocks and passes them to a consumer thread, that checks
+ * the tags and releases them remotely, while the owner keeps allocating (and draining).
+ */
+template<class Heap>
+bool remoteReleaseConsistent(Heap &heap)
+{
+    std::mutex mutex;
+    std::vector<uint32_t*> queue;
+    std::atomic<bool> done(false);
+    int errors = 0;
+
+    std::thread consumer([&]()
+    {
+        std::vector<uint32_t*> taken;
+
+        for(bool last = false; !last;)
+        {
+            last = done.load();
+
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                taken.swap(queue);
+            }
+
+            for(auto ptr: taken)
+            {
+                if(ptr[0] != ptr[1] * 3)
+                    errors++;
+
+                heap.remoteFree(ptr);
+            }
+
+            taken.clear();
+            std::this_thread::yield();
+        }
+    });
+
+    std::minstd_rand rng(11);
+
+    for(uint32_t i = 0; i < 100000; i++)
+    {
+        if(auto ptr = static_cast<uint32_t*>(heap.alloc(8 + rng() % 200)))
+        {
+            ptr[1] = i;
+            ptr[0] = i * 3;
+
+            std::lock_guard<std::mutex> lock(mutex);
+            queue.push_back(ptr);
+        }
+
+        if(i % 1000 == 0)
+            std::this_thread::yield();
+    }
+
+    done.store(true);
+    consumer.join();
+
+    heap.drain();
+    return !errors && heap.getStats().nUsed == 0;
+}
+
+}
+
+TEST_GROUP(OwnedHeap) {};
+
+TEST(OwnedHeap, RemoteFreeWhileAllocating)
+{
+    pet::OwnedHeap<pet::TlsfHeap<uint32_t, 3, true, true>> heap(area, sizeof(area));
+    CHECK(remoteReleaseConsistent(heap));
+
+    const auto stats = heap.getStats(area);
+    CHECK(stats.nUsed == 0 && stats.longestFree == stats.totalFree);
+}
+
+TEST(OwnedHeap, RemoteFreeOnGrowingHeap)
+{
+    pet::OwnedHeap<pet::GrowingHeap<pet::TlsfHeap<uint32_t, 3, true, true, 24>, pet::MmapProvider>> heap;
+    CHECK(remoteReleaseConsistent(heap));
+}
+
+TEST(OwnedHeap, DrainJoinsAdjacentBlocks)
+{
+    alignas(16) static char small[16384];
+    pet::OwnedHeap<pet::TlsfHeap<uint32_t, 3, true, true>> heap(small, sizeof(small));
+    std::vector<void*> ptrs;
+
+    while(void* ptr = heap.alloc(32))
+        ptrs.push_back(ptr);
+
+    CHECK(ptrs.size() > 200);
+
+    for(int i = 0; i < 200; i++)
+        heap.remoteFree(ptrs[i]);
+
+    heap.drain();
+
+    const auto stats = heap.getStats(small);
+    CHECK(stats.nUsed == ptrs.size() - 200);
+    CHECK(stats.longestFree == stats.totalFree && 200 * 32 <= stats.totalFree);
+}
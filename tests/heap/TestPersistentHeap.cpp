@@ -0,0 +1,264 @@
+/*******************************************************************************
+ *
+ * Copyright (c) 2026 Tamás Seller. All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *******************************************************************************/
+
+#include "1test/Test.h"
+
+#include "heap/PersistentHeap.h"
+#include "heap/BestFitPolicy.h"
+
+#include <string.h>
+
+namespace {
+
+using Relocatable = pet::BestFitHeap<uint32_t, 3, true, true, true>;
+using Wider = pet::BestFitHeap<uint32_t, 4, true, true, true>;
+
+struct Node
+{
+    pet::OffsetPtr<Node> next;
+    uint32_t value;
+};
+
+alignas(16) char first[64 << 10];
+alignas(16) char second[64 << 10];
+
+/*
+ * Clears both areas, like newly created files.
+ */
+void blank()
+{
+    memset(first, 0, sizeof(first));
+    memset(second, 0, sizeof(second));
+}
+
+/*
+ * Builds a list of n nodes (and some garbage blocks in between) reachable from the root.
+ */
+template<class Heap>
+void build(Heap &heap, uint32_t n)
+{
+    Node* head = nullptr;
+
+    for(auto i = 0u; i < n; i++)
+    {
+        auto garbage = heap.alloc(8 + i);
+        auto node = new(heap.template allocFor<Node>()) Node;
+        node->value = i;
+        node->next = head;
+        head = node;
+
+        if(i & 1)
+        {
+            heap.free(garbage);
+        }
+    }
+
+    heap.setRoot(head);
+}
+
+/*
+ * Checks that the list built by _build_ is intact.
+ */
+template<class Heap>
+bool listIntact(Heap &heap, uint32_t n)
+{
+    auto node = heap.template getRoot<Node>();
+
+    for(auto i = n; i--;)
+    {
+        if(!node || node->value != i)
+        {
+            return false;
+        }
+
+        node = node->next;
+    }
+
+    return node == nullptr;
+}
+
+/*
+ * The busy flag of the header, that follows the magic, the version and the alignment.
+ */
+volatile uint32_t &busyFlag(void* area) {
+    return static_cast<volatile uint32_t*>(area)[3];
+}
+
+}
+
+TEST_GROUP(PersistentHeap) {};
+
+TEST(PersistentHeap, CreateOnBlankArea)
+{
+    blank();
+    pet::PersistentHeap<Relocatable> heap;
+    CHECK(heap.open(first, sizeof(first)));
+    CHECK(!heap.wasInterrupted());
+    CHECK(heap.getRoot() == nullptr);
+
+    auto s = heap.getStats();
+    CHECK(s.nUsed == 0);
+    CHECK(s.longestFree == s.totalFree);
+}
+
+TEST(PersistentHeap, ReopenAtDifferentAddress)
+{
+    blank();
+    pet::HeapStat before;
+
+    {
+        pet::PersistentHeap<Relocatable> heap;
+        CHECK(heap.open(first, sizeof(first)));
+        build(heap, 100);
+        CHECK(listIntact(heap, 100));
+        before = heap.getStats();
+    }
+
+    memcpy(second, first, sizeof(second));
+    memset(first, 0xa5, sizeof(first));
+
+    pet::PersistentHeap<Relocatable> heap;
+    CHECK(heap.open(second, sizeof(second)));
+    CHECK(!heap.wasInterrupted());
+    CHECK(listIntact(heap, 100));
+
+    auto after = heap.getStats();
+    CHECK(after.nUsed == before.nUsed);
+    CHECK(after.totalUsed == before.totalUsed);
+    CHECK(after.totalFree == before.totalFree);
+    CHECK(after.longestFree == before.longestFree);
+
+    // The free store has been rebuilt for the new address, so the heap is fully usable.
+    auto node = heap.getRoot<Node>();
+    heap.setRoot(node->next);
+    heap.free(node);
+    CHECK(listIntact(heap, 99));
+
+    auto fresh = new(heap.allocFor<Node>()) Node;
+    fresh->value = 99;
+    fresh->next = heap.getRoot<Node>();
+    heap.setRoot(fresh);
+    CHECK(listIntact(heap, 100));
+    CHECK(heap.getStats().nUsed == before.nUsed);
+}
+
+TEST(PersistentHeap, Interrupted)
+{
+    blank();
+
+    {
+        pet::PersistentHeap<Relocatable> heap;
+        CHECK(heap.open(first, sizeof(first)));
+        build(heap, 10);
+        CHECK(busyFlag(first) == 0);
+    }
+
+    // A crash in the middle of an operation leaves the flag set.
+    busyFlag(first) = 1;
+
+    {
+        pet::PersistentHeap<Relocatable> heap;
+        CHECK(heap.open(first, sizeof(first)));
+        CHECK(heap.wasInterrupted());
+        CHECK(busyFlag(first) == 0);
+        CHECK(listIntact(heap, 10));
+    }
+
+    pet::PersistentHeap<Relocatable> heap;
+    CHECK(heap.open(first, sizeof(first)));
+    CHECK(!heap.wasInterrupted());
+}
+
+TEST(PersistentHeap, RejectIncompatible)
+{
+    blank();
+
+    {
+        pet::PersistentHeap<Relocatable> heap;
+        CHECK(heap.open(first, sizeof(first)));
+        build(heap, 10);
+    }
+
+    memcpy(second, first, sizeof(second));
+
+    pet::PersistentHeap<Relocatable> smaller;
+    CHECK(!smaller.open(first, sizeof(first) / 2));
+
+    pet::PersistentHeap<Wider> wider;
+    CHECK(!wider.open(first, sizeof(first)));
+
+    // The version follows the magic.
+    reinterpret_cast<uint32_t*>(second)[1]++;
+    pet::PersistentHeap<Relocatable> newer;
+    CHECK(!newer.open(second, sizeof(second)));
+
+    // Nothing has been overwritten by the failed attempts.
+    pet::PersistentHeap<Relocatable> heap;
+    CHECK(heap.open(first, sizeof(first)));
+    CHECK(listIntact(heap, 10));
+}
+
+TEST(PersistentHeap, RejectInconsistent)
+{
+    blank();
+
+    {
+        pet::PersistentHeap<Relocatable> heap;
+        CHECK(heap.open(first, sizeof(first)));
+        build(heap, 10);
+    }
+
+    memcpy(second, first, sizeof(second));
+
+    // Corrupt the size field of the header of the block of the first node.
+    pet::PersistentHeap<Relocatable> heap;
+    CHECK(heap.open(first, sizeof(first)));
+    auto node = heap.getRoot<Node>();
+    auto offset = reinterpret_cast<char*>(node) - first;
+    reinterpret_cast<uint32_t*>(second + offset)[-1] ^= 0x10;
+
+    pet::PersistentHeap<Relocatable> corrupted;
+    CHECK(!corrupted.open(second, sizeof(second)));
+
+    // Even with the format flag, an area with a valid header is not reinitialized.
+    CHECK(!corrupted.open(second, sizeof(second), true));
+}
+
+TEST(PersistentHeap, UnrecognizedDataNotOverwritten)
+{
+    blank();
+    memset(first, 0x5a, sizeof(first));
+
+    pet::PersistentHeap<Relocatable> heap;
+    CHECK(!heap.open(first, sizeof(first)));
+
+    for(auto i = 0u; i < sizeof(first); i++)
+    {
+        if(first[i] != 0x5a)
+        {
+            CHECK(false);
+            break;
+        }
+    }
+
+    CHECK(heap.open(first, sizeof(first), true));
+    CHECK(!heap.wasInterrupted());
+    build(heap, 10);
+    CHECK(listIntact(heap, 10));
+}
@@ -0,0 +1,166 @@
+/*******************************************************************************
+ *
+ * Copyright (c) 2026 Tamás Seller. All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *******************************************************************************/
+
+#include "1test/Test.h"
+
+#include "heap/QuickListHeap.h"
+#include "heap/TlsfPolicy.h"
+#include "heap/GrowingHeap.h"
+#include "platform/linux/MmapProvider.h"
+
+#include <vector>
+#include <random>
+
+namespace {
+
+alignas(16) char area[1 << 18];
+
+/*
+ * Checks that every small block released is handed out again for a request
+ * of its own size, also when the header is not a multiple of the alignment.
+ */
+template<class Heap>
+bool reusesOwnSize()
+{
+    pet::QuickListHeap<Heap> heap(area, sizeof(area));
+
+    for(uintptr_t size = 0; size <= 128; size++)
+    {
+        void* ptr = heap.alloc(size);
+        heap.free(ptr);
+
+        if(heap.alloc(size) != ptr)
+            return false;
+
+        heap.free(ptr);
+    }
+
+    heap.flush();
+
+    for(int i = 0; i < 1000; i++)
+        heap.free(heap.alloc(24));
+
+    return heap.getStats().nUsed == 1;
+}
+
+/*
+ * Allocates and releases random small and large blocks, checking the
+ * contents, and that everything gets back to the heap on a flush.
+ */
+template<class Heap>
+bool contentsRetained()
+{
+    pet::QuickListHeap<Heap> heap(area, sizeof(area));
+    std::vector<std::pair<unsigned char*, uintptr_t>> live;
+    std::minstd_rand rng(5);
+
+    for(int i = 0; i < 50000; i++)
+    {
+        if(live.size() < 100 && rng() % 2)
+        {
+            const uintptr_t size = (rng() % 8) ? rng() % 140 + 1 : rng() % 2000 + 1;
+
+            if(auto ptr = static_cast<unsigned char*>(heap.alloc(size)))
+            {
+                for(uintptr_t j = 0; j < size; j++)
+                    ptr[j] = (unsigned char)(size + j);
+
+                live.push_back({ptr, size});
+            }
+        }
+        else if(!live.empty())
+        {
+            const auto idx = rng() % live.size();
+            const auto b = live[idx];
+
+            for(uintptr_t j = 0; j < b.second; j++)
+                if(b.first[j] != (unsigned char)(b.second + j))
+                    return false;
+
+            heap.free(b.first);
+            live[idx] = live.back();
+            live.pop_back();
+        }
+    }
+
+    for(auto &b: live)
+        heap.free(b.first);
+
+    heap.flush();
+
+    const auto walked = heap.getStats(area);
+    return heap.getStats().nUsed == 0 && walked.nUsed == 0 && walked.longestFree == walked.totalFree;
+}
+
+}
+
+TEST_GROUP(QuickListHeap) {};
+
+TEST(QuickListHeap, ReusesOwnSize)
+{
+    CHECK(reusesOwnSize<pet::TlsfHeap<uint32_t, 3, false, true>>());
+    CHECK(reusesOwnSize<pet::TlsfHeap<uint32_t, 4, false, true>>());
+    CHECK(reusesOwnSize<pet::TlsfHeap<uint16_t, 3, false, true>>());
+}
+
+TEST(QuickListHeap, ContentsRetained)
+{
+    CHECK(contentsRetained<pet::TlsfHeap<uint32_t, 3, true, true>>());
+    CHECK(contentsRetained<pet::TlsfHeap<uint32_t, 4, false, true>>());
+    CHECK(contentsRetained<pet::TlsfHeap<uint16_t, 3, false, true>>());
+}
+
+TEST(QuickListHeap, ListLengthLimited)
+{
+    pet::QuickListHeap<pet::TlsfHeap<uint32_t, 3, false, true>, 128, 16> heap(area, sizeof(area));
+    void* ptrs[100];
+
+    for(auto &p: ptrs)
+        p = heap.alloc(24);
+
+    for(auto p: ptrs)
+        heap.free(p);
+
+    CHECK(heap.getStats().nUsed == 16);
+    CHECK(heap.flush());
+    CHECK(heap.getStats().nUsed == 0);
+    CHECK(!heap.flush());
+}
+
+TEST(QuickListHeap, GrowingHeapBounded)
+{
+    pet::QuickListHeap<pet::GrowingHeap<pet::TlsfHeap<uint32_t, 3, false, true, 24>, pet::MmapProvider, 64 * 1024>> heap;
+    std::vector<void*> ptrs;
+
+    for(int round = 0; round < 10; round++)
+    {
+        for(int i = 0; i < 5000; i++)
+            ptrs.push_back(heap.alloc(8 + 8 * (i % 8)));
+
+        for(auto p: ptrs)
+            heap.free(p);
+
+        ptrs.clear();
+
+        CHECK(heap.getStats().nUsed <= 8 * 32);
+    }
+
+    heap.flush();
+    CHECK(heap.getStats().nUsed == 0);
+}
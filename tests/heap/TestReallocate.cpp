@@ -0,0 +1,134 @@
+/*******************************************************************************
+ *
+ * Copyright (c) 2026 Tamás Seller. All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *******************************************************************************/
+
+#include "1test/Test.h"
+
+#include "heap/TlsfPolicy.h"
+#include "heap/BestFitPolicy.h"
+
+#include <vector>
+#include <random>
+
+namespace {
+
+alignas(16) char area[1 << 16];
+
+struct Block
+{
+    unsigned char* ptr;
+    uintptr_t size;
+    unsigned char seed;
+};
+
+/*
+ * Reallocates random blocks (including the moves into the preceding free
+ * block), checking that the contents are retained byte by byte.
+ */
+template<class Heap>
+bool contentsRetained(int nOps)
+{
+    Heap heap(area, sizeof(area));
+    std::vector<Block> live;
+    std::minstd_rand rng(3);
+
+    for(int i = 0; i < nOps; i++)
+    {
+        if(live.size() < 20 && rng() % 2)
+        {
+            const uintptr_t size = rng() % 700 + 1;
+
+            if(auto ptr = static_cast<unsigned char*>(heap.alloc(size)))
+            {
+                const auto seed = (unsigned char)rng();
+
+                for(uintptr_t j = 0; j < size; j++)
+                    ptr[j] = (unsigned char)(seed + j);
+
+                live.push_back({ptr, size, seed});
+            }
+        }
+        else if(!live.empty())
+        {
+            const auto idx = rng() % live.size();
+            auto &b = live[idx];
+
+            for(uintptr_t j = 0; j < b.size; j++)
+                if(b.ptr[j] != (unsigned char)(b.seed + j))
+                    return false;
+
+            if(rng() % 3)
+            {
+                const uintptr_t size = rng() % 1400 + 1;
+
+                if(auto ptr = static_cast<unsigned char*>(heap.reallocate(b.ptr, size)))
+                {
+                    b.ptr = ptr;
+
+                    for(uintptr_t j = b.size; j < size; j++)
+                        ptr[j] = (unsigned char)(b.seed + j);
+
+                    b.size = size;
+                }
+            }
+            else
+            {
+                heap.free(b.ptr);
+                live[idx] = live.back();
+                live.pop_back();
+            }
+        }
+    }
+
+    return true;
+}
+
+}
+
+TEST_GROUP(Reallocate) {};
+
+TEST(Reallocate, ContentsRetained)
+{
+    CHECK(contentsRetained<pet::TlsfHeap<uint32_t, 3, true>>(20000));
+    CHECK(contentsRetained<pet::TlsfHeap<uint16_t, 3>>(20000));
+    CHECK(contentsRetained<pet::BestFitHeap<uint16_t, 3>>(20000));
+}
+
+TEST(Reallocate, HugeRequestLeavesBlockIntact)
+{
+    pet::TlsfHeap<uint32_t, 3, true> heap(area, sizeof(area));
+    auto ptr = static_cast<unsigned char*>(heap.alloc(200));
+    auto next = heap.alloc(16);
+    const auto size = heap.getSize(ptr);
+
+    for(uintptr_t i = 0; i < size; i++)
+        ptr[i] = (unsigned char)i;
+
+    for(uintptr_t request: {UINTPTR_MAX, UINTPTR_MAX - 2, UINTPTR_MAX - 100, UINTPTR_MAX / 2})
+    {
+        CHECK(heap.reallocate(ptr, request) == nullptr);
+        CHECK(heap.resize(ptr, request) == size);
+        CHECK(heap.getSize(ptr) == size);
+    }
+
+    for(uintptr_t i = 0; i < size; i++)
+        CHECK(ptr[i] == (unsigned char)i);
+
+    heap.free(ptr);
+    heap.free(next);
+}
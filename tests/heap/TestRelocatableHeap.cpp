@@ -0,0 +1,176 @@
+/*******************************************************************************
+ *
+ * Copyright (c) 2026 Tamás Seller. All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *******************************************************************************/
+
+#include "1test/Test.h"
+
+#include "heap/RelocatableHeap.h"
+#include "heap/TlsfPolicy.h"
+#include "heap/BestFitPolicy.h"
+
+#include <vector>
+#include <random>
+
+namespace {
+
+alignas(16) char area[1 << 16];
+
+template<class Heap>
+struct Live
+{
+    typename pet::RelocatableHeap<Heap, 256>::Handle handle;
+    uintptr_t size;
+    unsigned char seed;
+};
+
+template<class Heap>
+bool intact(pet::RelocatableHeap<Heap, 256> &heap, const std::vector<Live<Heap>> &live)
+{
+    for(const auto &b: live)
+    {
+        const auto data = static_cast<unsigned char*>(heap.get(b.handle));
+
+        for(uintptr_t j = 0; j < b.size; j++)
+            if(data[j] != (unsigned char)(b.seed + j))
+                return false;
+    }
+
+    return true;
+}
+
+template<class Heap>
+void fill(pet::RelocatableHeap<Heap, 256> &heap, const Live<Heap> &b, uintptr_t from)
+{
+    const auto data = static_cast<unsigned char*>(heap.get(b.handle));
+
+    for(uintptr_t j = from; j < b.size; j++)
+        data[j] = (unsigned char)(b.seed + j);
+}
+
+/*
+ * Interleaves allocations, releases and resizes with compaction steps, checking
+ * the contents of all the live blocks through their handles after every step,
+ * then compacts the heap fully and checks that the free space got coalesced.
+ */
+template<class Heap>
+bool contentsRetained(int nOps)
+{
+    static pet::RelocatableHeap<Heap, 256> heap;
+    heap.init(area, sizeof(area));
+
+    std::vector<Live<Heap>> live;
+    std::minstd_rand rng(7);
+
+    for(int i = 0; i < nOps; i++)
+    {
+        const auto op = rng() % 8;
+
+        if(op < 3 && live.size() < 200)
+        {
+            const uintptr_t size = rng() % 600 + 1;
+
+            if(auto handle = heap.alloc(size))
+            {
+                live.push_back({handle, size, (unsigned char)rng()});
+                fill(heap, live.back(), 0);
+            }
+        }
+        else if(op < 5 && !live.empty())
+        {
+            const auto idx = rng() % live.size();
+            heap.free(live[idx].handle);
+            live[idx] = live.back();
+            live.pop_back();
+        }
+        else if(op < 6 && !live.empty())
+        {
+            auto &b = live[rng() % live.size()];
+            const uintptr_t size = rng() % 900 + 1;
+            const auto result = heap.resize(b.handle, size);
+
+            if(result < size && result < b.size)
+                return false;
+
+            if(size <= result)
+            {
+                const auto old = b.size;
+                b.size = size;
+                fill(heap, b, old < size ? old : size);
+            }
+        }
+        else
+        {
+            heap.compact(rng() % 4 + 1);
+        }
+
+        if(!intact(heap, live))
+            return false;
+    }
+
+    std::vector<Live<Heap>> kept;
+
+    for(size_t i = 0; i < live.size(); i++)
+    {
+        if(i % 2)
+            heap.free(live[i].handle);
+        else
+            kept.push_back(live[i]);
+    }
+
+    live.swap(kept);
+
+    for(int i = 0; heap.compact(16); i++)
+    {
+        if(!intact(heap, live) || i > 100000)
+            return false;
+    }
+
+    const auto stats = heap.getStats();
+    return intact(heap, live) && stats.longestFree == stats.totalFree && stats.nUsed == live.size();
+}
+
+}
+
+TEST_GROUP(RelocatableHeap) {};
+
+TEST(RelocatableHeap, ContentsRetained)
+{
+    CHECK(contentsRetained<pet::TlsfHeap<uint32_t, 3, true>>(20000));
+    CHECK(contentsRetained<pet::TlsfHeap<uint16_t, 3>>(20000));
+    CHECK(contentsRetained<pet::BestFitHeap<uint32_t, 3>>(20000));
+}
+
+TEST(RelocatableHeap, HugeRequestRejected)
+{
+    static pet::RelocatableHeap<pet::TlsfHeap<uint32_t, 3, true>, 16> heap;
+    heap.init(area, sizeof(area));
+
+    CHECK(!heap.alloc(UINTPTR_MAX));
+    CHECK(!heap.alloc(UINTPTR_MAX - 4));
+
+    auto handle = heap.alloc(100);
+    CHECK(handle);
+
+    const auto size = heap.resize(handle, 100);
+    CHECK(100 <= size);
+    CHECK(heap.resize(handle, UINTPTR_MAX) == size);
+    CHECK(heap.resize(handle, UINTPTR_MAX - 4) == size);
+
+    heap.free(handle);
+    CHECK(heap.getStats().nUsed == 0);
+}
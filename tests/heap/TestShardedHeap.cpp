@@ -0,0 +1,151 @@
+/*******************************************************************************
+ *
+ * Copyright (c) 2026 Tamás Seller. All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *******************************************************************************/
+
+#include "1test/Test.h"
+
+#include "heap/ShardedHeap.h"
+#include "heap/TlsfPolicy.h"
+
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace {
+
+alignas(64) char area[4 * 16384];
+
+/// Selects the arena set by the test.
+struct FixedSelector
+{
+    static inline unsigned int index;
+    static inline unsigned int current() { return index; }
+};
+
+using Heap = pet::ShardedHeap<pet::TlsfHeap<uint32_t, 3, true>, std::mutex, 4, FixedSelector>;
+
+inline unsigned int arenaIndex(void* ptr) {
+    return unsigned((static_cast<char*>(ptr) - area) / (sizeof(area) / 4));
+}
+
+}
+
+TEST_GROUP(ShardedHeap) {};
+
+TEST(ShardedHeap, FreeFromOtherArena)
+{
+    static Heap heap;
+    heap.init(area, sizeof(area));
+
+    FixedSelector::index = 1;
+    void* a = heap.alloc(100);
+    CHECK(arenaIndex(a) == 1);
+
+    FixedSelector::index = 2;
+    void* b = heap.alloc(100);
+    CHECK(arenaIndex(b) == 2);
+
+    heap.free(a);
+    FixedSelector::index = 3;
+    heap.free(b);
+
+    CHECK(heap.getStats().nUsed == 0);
+
+    FixedSelector::index = 1;
+    CHECK(heap.alloc(100) == a);
+}
+
+TEST(ShardedHeap, SpillAndReallocateAcross)
+{
+    static Heap heap;
+    heap.init(area, sizeof(area));
+
+    FixedSelector::index = 0;
+    std::vector<void*> filler;
+
+    while(void* ptr = heap.alloc(1000))
+    {
+        if(arenaIndex(ptr) != 0)
+        {
+            CHECK(arenaIndex(ptr) == 1);
+            heap.free(ptr);
+            break;
+        }
+
+        filler.push_back(ptr);
+    }
+
+    auto moved = static_cast<unsigned char*>(filler.back());
+
+    for(int i = 0; i < 1000; i++)
+        moved[i] = (unsigned char)i;
+
+    filler.pop_back();
+    moved = static_cast<unsigned char*>(heap.reallocate(moved, 8000));
+    CHECK(moved && arenaIndex(moved) == 1);
+
+    for(int i = 0; i < 1000; i++)
+        CHECK(moved[i] == (unsigned char)i);
+
+    for(auto p: filler)
+        heap.free(p);
+
+    heap.free(moved);
+    CHECK(heap.getStats().nUsed == 0);
+}
+
+TEST(ShardedHeap, ReleaseFromOtherThreads)
+{
+    alignas(64) static char space[4 << 20];
+    static pet::ShardedHeap<pet::TlsfHeap<uint32_t, 3, true>, std::mutex, 4> heap;
+    heap.init(space, sizeof(space));
+
+    std::vector<void*> blocks[4];
+    std::vector<std::thread> threads;
+
+    for(int t = 0; t < 4; t++)
+    {
+        threads.emplace_back([&, t]()
+        {
+            for(int i = 0; i < 1000; i++)
+                if(void* ptr = heap.alloc(16 + (i % 64) * 8))
+                    blocks[t].push_back(ptr);
+        });
+    }
+
+    for(auto &t: threads)
+        t.join();
+
+    threads.clear();
+
+    for(int t = 0; t < 4; t++)
+    {
+        CHECK(blocks[t].size() == 1000);
+
+        threads.emplace_back([&, t]()
+        {
+            for(auto ptr: blocks[(t + 1) % 4])
+                heap.free(ptr);
+        });
+    }
+
+    for(auto &t: threads)
+        t.join();
+
+    CHECK(heap.getStats().nUsed == 0);
+}
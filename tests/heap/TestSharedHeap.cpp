@@ -0,0 +1,321 @@
+/*******************************************************************************
+ *
+ * Copyright (c) 2026 Tamás Seller. All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *******************************************************************************/
+
+#include "1test/Test.h"
+
+#include "heap/SharedHeap.h"
+#include "heap/BestFitPolicy.h"
+#include "data/OffsetAtomicList.h"
+#include "data/Fifo.h"
+#include "platform/linux/SharedMemory.h"
+#include "platform/linux/ProcessSharedMutex.h"
+
+#include <sys/wait.h>
+#include <unistd.h>
+#include <string.h>
+
+namespace {
+
+using Relocatable = pet::BestFitHeap<uint32_t, 3, true, true, true>;
+
+/*
+ * Robust lock that can be made to kill the process right after locking, so that the
+ * lock is left abandoned, as if the process died in the middle of an operation.
+ */
+struct DyingMutex: pet::ProcessSharedMutex
+{
+    static inline bool dieWhenLocked = false;
+
+    inline void lock()
+    {
+        pet::ProcessSharedMutex::lock();
+
+        if(dieWhenLocked)
+        {
+            _exit(0);
+        }
+    }
+};
+
+using Shared = pet::SharedHeap<Relocatable, DyingMutex>;
+
+constexpr uintptr_t areaSize = 1 << 20;
+
+/*
+ * The same anonymous shared memory object mapped twice, like by two processes.
+ */
+struct TwoMappings
+{
+    pet::SharedMemory first, second;
+    char *a, *b;
+
+    TwoMappings()
+    {
+        a = static_cast<char*>(first.create(areaSize));
+        b = static_cast<char*>(second.map(dup(first.getFd()), areaSize));
+    }
+
+    bool inSecond(const void* ptr) const {
+        return b <= static_cast<const char*>(ptr) && static_cast<const char*>(ptr) < b + areaSize;
+    }
+};
+
+struct Node
+{
+    pet::OffsetPtr<Node> next;
+    uint32_t value;
+};
+
+struct Message: pet::OffsetAtomicList::Element
+{
+    uint32_t value;
+    inline Message(uint32_t value): value(value) {}
+};
+
+struct Channel
+{
+    pet::OffsetFifo<16, uint32_t> fifo;
+    inline Channel(uint32_t* buffer): fifo(buffer) {}
+};
+
+/*
+ * Runs a child process that dies holding the lock of the heap.
+ */
+bool abandonLock(Shared &heap)
+{
+    const auto pid = fork();
+
+    if(!pid)
+    {
+        DyingMutex::dieWhenLocked = true;
+        heap.alloc(16);
+        _exit(1);
+    }
+
+    int status;
+    return waitpid(pid, &status, 0) == pid && WIFEXITED(status) && WEXITSTATUS(status) == 0;
+}
+
+}
+
+TEST_GROUP(SharedHeap) {};
+
+TEST(SharedHeap, OpenAtSecondMapping)
+{
+    TwoMappings m;
+    CHECK(m.a && m.b && m.a != m.b);
+
+    Shared h1, h2;
+    CHECK(!h2.open(m.b, areaSize));
+
+    h1.create(m.a, areaSize);
+    CHECK(!h2.open(m.b, areaSize / 2));
+    CHECK(h2.open(m.b, areaSize));
+
+    auto p = static_cast<char*>(h1.alloc(100));
+    memset(p, 0x5a, 100);
+
+    auto q = h2.atOffset<char>(h1.offsetOf(p));
+    CHECK(m.inSecond(q));
+    CHECK(h2.offsetOf(q) == h1.offsetOf(p));
+    CHECK(q[0] == 0x5a && q[99] == 0x5a);
+    CHECK(h2.getStats().nUsed == 1);
+
+    // Released through the other mapping, the heap adjusts to each one on every operation.
+    h2.free(q);
+    CHECK(h1.getStats().nUsed == 0);
+
+    auto s = h1.getStats();
+    CHECK(s.longestFree == s.totalFree);
+    CHECK(!h1.isBroken());
+}
+
+TEST(SharedHeap, OffsetPtrAcrossMappings)
+{
+    TwoMappings m;
+    Shared h1, h2;
+    h1.create(m.a, areaSize);
+    CHECK(h2.open(m.b, areaSize));
+
+    Node* head = nullptr;
+
+    for(auto i = 0u; i < 50; i++)
+    {
+        auto node = new(h1.allocFor<Node>()) Node;
+        node->value = i;
+        node->next = head;
+        head = node;
+    }
+
+    h1.setRoot(head);
+
+    auto node = h2.getRoot<Node>();
+
+    for(auto i = 50u; i--;)
+    {
+        CHECK(m.inSecond(node));
+        CHECK(node->value == i);
+        auto next = node->next.get();
+        h2.free(node);
+        node = next;
+    }
+
+    CHECK(node == nullptr);
+    CHECK(h1.getStats().nUsed == 0);
+}
+
+TEST(SharedHeap, OffsetAtomicListAcrossMappings)
+{
+    TwoMappings m;
+    Shared h1, h2;
+    h1.create(m.a, areaSize);
+    CHECK(h2.open(m.b, areaSize));
+
+    auto list = new(h1.allocFor<pet::OffsetAtomicList>()) pet::OffsetAtomicList;
+    h1.setRoot(list);
+
+    auto local = h2.getRoot<pet::OffsetAtomicList>();
+    CHECK(m.inSecond(local));
+    CHECK(local->isEmpty());
+
+    for(auto i = 0u; i < 20; i++)
+    {
+        auto msg = new(h1.allocFor<Message>()) Message(i);
+        CHECK(list->push(msg));
+        CHECK(!list->push(msg));
+    }
+
+    CHECK(!local->isEmpty());
+
+    auto reader = local->read();
+    CHECK(list->isEmpty());
+
+    for(auto i = 0u; i < 20; i++)
+    {
+        auto msg = static_cast<Message*>(reader.peek());
+        CHECK(m.inSecond(msg));
+        CHECK(msg->value == i);
+        reader.pop();
+
+        // Popped elements can be pushed again.
+        if(i == 19)
+        {
+            CHECK(local->push(msg));
+            CHECK(!list->isEmpty());
+        }
+        else
+        {
+            h2.free(msg);
+        }
+    }
+
+    CHECK(reader.peek() == nullptr);
+    CHECK(h1.getStats().nUsed == 2);
+}
+
+TEST(SharedHeap, OffsetFifoAcrossMappings)
+{
+    TwoMappings m;
+    Shared h1, h2;
+    h1.create(m.a, areaSize);
+    CHECK(h2.open(m.b, areaSize));
+
+    auto buffer = static_cast<uint32_t*>(h1.alloc(16 * sizeof(uint32_t)));
+    auto channel = new(h1.allocFor<Channel>()) Channel(buffer);
+    h1.setRoot(channel);
+
+    auto local = h2.getRoot<Channel>();
+    CHECK(m.inSecond(local));
+
+    for(auto round = 0u; round < 3; round++)
+    {
+        for(auto i = 0u; i < 16; i++)
+        {
+            auto block = static_cast<uint32_t*>(h1.alloc(8));
+            *block = round * 16 + i;
+            CHECK(channel->fifo.writeOne(uint32_t(h1.offsetOf(block))));
+        }
+
+        CHECK(!channel->fifo.writeOne(0));
+
+        for(auto i = 0u; i < 16; i++)
+        {
+            uint32_t offset = 0;
+            CHECK(local->fifo.readOne(offset));
+
+            auto block = h2.atOffset<uint32_t>(offset);
+            CHECK(m.inSecond(block));
+            CHECK(*block == round * 16 + i);
+            h2.free(block);
+        }
+
+        uint32_t dummy;
+        CHECK(!local->fifo.readOne(dummy));
+    }
+
+    CHECK(h1.getStats().nUsed == 2);
+}
+
+TEST(SharedHeap, RecoverAbandonedLock)
+{
+    TwoMappings m;
+    Shared h1, h2;
+    h1.create(m.a, areaSize);
+    CHECK(h2.open(m.b, areaSize));
+
+    auto p = static_cast<uint32_t*>(h1.alloc(64));
+    *p = 0x12345678;
+
+    CHECK(abandonLock(h1));
+
+    // The heap is verified by the next operation and found consistent.
+    CHECK(!h2.isBroken());
+    auto q = h2.alloc(64);
+    CHECK(q != nullptr);
+    CHECK(*h2.atOffset<uint32_t>(h1.offsetOf(p)) == 0x12345678);
+    CHECK(h1.getStats().nUsed == 2);
+
+    h1.free(p);
+    h2.free(q);
+    CHECK(h1.getStats().nUsed == 0);
+}
+
+TEST(SharedHeap, RefuseCorruptedAfterAbandonedLock)
+{
+    TwoMappings m;
+    Shared h1, h2;
+    h1.create(m.a, areaSize);
+    CHECK(h2.open(m.b, areaSize));
+
+    auto p = static_cast<uint32_t*>(h1.alloc(64));
+    auto q = h1.alloc(64);
+
+    CHECK(abandonLock(h1));
+
+    // As if the dead process had been in the middle of writing the header of the block.
+    p[-1] ^= 0x10;
+
+    CHECK(h2.alloc(16) == nullptr);
+    CHECK(h1.isBroken());
+    CHECK(h2.isBroken());
+    CHECK(h1.reallocate(q, 128) == nullptr);
+    CHECK(h1.resize(q, 32) == 0);
+    h1.free(q);
+    CHECK(h1.getStats().nUsed == 0);
+}
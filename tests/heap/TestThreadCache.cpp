@@ -0,0 +1,253 @@
+/*******************************************************************************
+ *
+ * Copyright (c) 2026 Tamás Seller. All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *******************************************************************************/
+
+#include "1test/Test.h"
+
+#include "heap/ThreadCache.h"
+#include "heap/TlsfPolicy.h"
+#include "heap/GrowingHeap.h"
+#include "heap/ShardedHeap.h"
+#include "heap/SharedHeap.h"
+#include "heap/PersistentHeap.h"
+#include "heap/BestFitPolicy.h"
+#include "platform/linux/MmapProvider.h"
+
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <random>
+
+namespace {
+
+using Tlsf = pet::TlsfHeap<uint32_t, 3, true, true>;
+using Relocatable = pet::BestFitHeap<uint32_t, 3, true, true, true>;
+
+alignas(64) char area[4 << 20];
+
+/*
+ * Allocates and releases tagged blocks through thread caches from several threads,
+ * then checks that everything got back into the heap after flushing the caches.
+ */
+template<class Heap>
+bool cachedBlocksConsistent(Heap &heap)
+{
+    std::mutex mutex;
+    std::vector<std::thread> threads;
+    int errors[4] = {0,};
+
+    for(int t = 0; t < 4; t++)
+    {
+        threads.emplace_back([&, t]()
+        {
+            pet::ThreadCache<Heap, std::mutex> cache(heap, mutex);
+            std::vector<std::pair<uint32_t*, uint32_t>> live;
+            std::minstd_rand rng(t + 1);
+
+            for(int i = 0; i < 20000; i++)
+            {
+                if(live.size() < 200 && rng() % 2)
+                {
+                    if(auto ptr = static_cast<uint32_t*>(cache.alloc(sizeof(uint32_t) + rng() % 300)))
+                    {
+                        *ptr = t << 24 | i;
+                        live.push_back({ptr, *ptr});
+                    }
+                }
+                else if(!live.empty())
+                {
+                    const auto idx = rng() % live.size();
+
+                    if(*live[idx].first != live[idx].second)
+                        errors[t]++;
+
+                    cache.free(live[idx].first);
+                    live[idx] = live.back();
+                    live.pop_back();
+                }
+            }
+
+            for(auto &e: live)
+                cache.free(e.first);
+
+            cache.flush();
+        });
+    }
+
+    for(auto &t: threads)
+        t.join();
+
+    return !errors[0] && !errors[1] && !errors[2] && !errors[3] && heap.getStats().nUsed == 0;
+}
+
+/*
+ * Lock that counts how many times the shared heap has been accessed.
+ */
+struct CountingMutex
+{
+    std::mutex mutex;
+    unsigned int locks = 0;
+
+    void lock()
+    {
+        mutex.lock();
+        locks++;
+    }
+
+    void unlock() {
+        mutex.unlock();
+    }
+};
+
+using Cache = pet::ThreadCache<Tlsf, CountingMutex, 16, 16, 32>;
+
+}
+
+TEST_GROUP(ThreadCache) {};
+
+TEST(ThreadCache, ReusesFreedBlocks)
+{
+    Tlsf heap(area, sizeof(area));
+    CountingMutex mutex;
+    Cache cache(heap, mutex);
+
+    // The first allocation fetches half a magazine in one go.
+    auto a = cache.alloc(40);
+    CHECK(a != nullptr);
+    CHECK(Tlsf::getSize(a) >= 40);
+    CHECK(mutex.locks == 1);
+    CHECK(heap.getStats().nUsed == 16);
+
+    // The most recently freed block is handed out again, without touching the heap.
+    cache.free(a);
+    CHECK(cache.alloc(33) == a);
+
+    for(int i = 0; i < 1000; i++)
+    {
+        auto p = cache.alloc(1 + i % 48);
+        CHECK(Tlsf::getSize(p) >= uintptr_t(1 + i % 48));
+        cache.free(p);
+    }
+
+    CHECK(mutex.locks <= 4);
+
+    cache.free(a);
+    cache.flush();
+    CHECK(heap.getStats().nUsed == 0);
+    CHECK(heap.getStats(area).nUsed == 0);
+}
+
+TEST(ThreadCache, RefillsAndDrainsInBatches)
+{
+    Tlsf heap(area, sizeof(area));
+    CountingMutex mutex;
+    Cache cache(heap, mutex);
+
+    void* blocks[64];
+
+    for(auto &b: blocks)
+        b = cache.alloc(100);
+
+    // Four refills of sixteen.
+    CHECK(mutex.locks == 4);
+    CHECK(heap.getStats().nUsed == 64);
+
+    // A full magazine is drained by half when another block arrives.
+    for(int i = 0; i < 32; i++)
+        cache.free(blocks[i]);
+
+    CHECK(mutex.locks == 4);
+    CHECK(heap.getStats().nUsed == 64);
+
+    cache.free(blocks[32]);
+    CHECK(mutex.locks == 5);
+    CHECK(heap.getStats().nUsed == 64 - 16);
+
+    for(int i = 33; i < 64; i++)
+        cache.free(blocks[i]);
+
+    CHECK(mutex.locks == 6);
+    CHECK(heap.getStats().nUsed == 64 - 32);
+
+    // Everything goes back in a single locked session.
+    cache.flush();
+    CHECK(mutex.locks == 7);
+    CHECK(heap.getStats().nUsed == 0);
+}
+
+TEST(ThreadCache, LargeRequestsBypassCache)
+{
+    Tlsf heap(area, sizeof(area));
+    CountingMutex mutex;
+
+    {
+        Cache cache(heap, mutex);
+
+        auto large = cache.alloc(1000);
+        CHECK(large != nullptr);
+        CHECK(heap.getStats().nUsed == 1);
+
+        cache.free(large);
+        CHECK(heap.getStats().nUsed == 0);
+        CHECK(mutex.locks == 2);
+
+        // Blocks obtained elsewhere are binned by their usable size.
+        void* direct = heap.alloc(60);
+        cache.free(direct);
+        CHECK(heap.getStats().nUsed == 1);
+        CHECK(cache.alloc(Tlsf::getSize(direct) & ~uintptr_t(15)) == direct);
+        cache.free(direct);
+    }
+
+    // The destructor flushes the cache.
+    CHECK(heap.getStats().nUsed == 0);
+}
+
+TEST(ThreadCache, Heap)
+{
+    Tlsf heap(area, sizeof(area));
+    CHECK(cachedBlocksConsistent(heap));
+    CHECK(heap.getStats(area).nUsed == 0);
+}
+
+TEST(ThreadCache, GrowingHeap)
+{
+    pet::GrowingHeap<pet::TlsfHeap<uint32_t, 3, true, true, 24>, pet::MmapProvider> heap;
+    CHECK(cachedBlocksConsistent(heap));
+}
+
+TEST(ThreadCache, ShardedHeap)
+{
+    pet::ShardedHeap<Tlsf, std::mutex, 4> heap;
+    heap.init(area, sizeof(area));
+    CHECK(cachedBlocksConsistent(heap));
+}
+
+TEST(ThreadCache, SharedHeap)
+{
+    pet::SharedHeap<Relocatable, std::mutex> heap;
+    heap.create(area, sizeof(area));
+    CHECK(cachedBlocksConsistent(heap));
+}
+
+TEST(ThreadCache, PersistentHeap)
+{
+    pet::PersistentHeap<Relocatable> heap;
+    CHECK(heap.open(area, sizeof(area), true));
+    CHECK(cachedBlocksConsistent(heap));
+}
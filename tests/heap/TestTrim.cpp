@@ -0,0 +1,236 @@
+/*******************************************************************************
+ *
+ * Copyright (c) 2026 Tamás Seller. All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *******************************************************************************/
+
+#include "1test/Test.h"
+
+#include "heap/TlsfPolicy.h"
+#include "heap/GrowingHeap.h"
+#include "platform/linux/MmapProvider.h"
+
+#include <vector>
+#include <random>
+#include <string.h>
+
+namespace {
+
+using Heap = pet::TlsfHeap<uint32_t, 3, true, true>;
+
+/// The size of the block header of the heap (with checksum).
+constexpr uintptr_t headerSize = 3 * sizeof(uint32_t);
+
+/// The size of the header of the free blocks stored by the TLSF policy (the links of the free list).
+constexpr uintptr_t freeHeaderSize = 2 * sizeof(void*);
+constexpr uintptr_t pageSize = 4096;
+
+alignas(pageSize) char area[1 << 20];
+
+struct Range
+{
+    uintptr_t start, length;
+};
+
+/*
+ * Discard function that records the ranges and overwrites them with garbage (the
+ * pages read as zeroes after a real discard), so that any header in them breaks.
+ */
+struct Recorder
+{
+    std::vector<Range> ranges;
+
+    inline void operator()(void* ptr, uintptr_t length)
+    {
+        ranges.push_back({(uintptr_t)ptr, length});
+        memset(ptr, 0xdb, length);
+    }
+};
+
+/// Whether the range is page aligned and inside the payload of a free block, past the header of the policy.
+bool insideFreePayload(Heap &heap, const Range &r)
+{
+    if(r.start % pageSize || r.length % pageSize || !r.length)
+        return false;
+
+    for(void* ptr = Heap::firstBlock(area); ptr; ptr = heap.nextBlock(ptr))
+    {
+        const auto next = heap.nextBlock(ptr);
+        const auto from = (uintptr_t)ptr;
+        const auto to = next ? (uintptr_t)next - headerSize : (uintptr_t)area + sizeof(area);
+
+        if(from <= r.start && r.start < to)
+            return Heap::isFree(ptr) && from + freeHeaderSize <= r.start && r.start + r.length <= to;
+    }
+
+    return false;
+}
+
+}
+
+TEST_GROUP(Trim) {};
+
+TEST(Trim, DiscardsOnlyFreePayload)
+{
+    Heap heap(area, sizeof(area));
+    std::vector<void*> live;
+    std::minstd_rand rng(19);
+
+    for(int round = 0; round < 200; round++)
+    {
+        for(int i = 0; i < 20; i++)
+        {
+            if(live.size() < 60 && rng() % 2)
+            {
+                if(void* ptr = heap.alloc(rng() % 3 ? rng() % 200 + 1 : rng() % 40000 + 1))
+                {
+                    memset(ptr, 0x5a, heap.getSize(ptr));
+                    live.push_back(ptr);
+                }
+            }
+            else if(!live.empty())
+            {
+                const auto idx = rng() % live.size();
+                heap.free(live[idx]);
+                live[idx] = live.back();
+                live.pop_back();
+            }
+        }
+
+        Recorder recorder;
+        uintptr_t total = 0;
+        const auto discarded = heap.trim(area, pageSize, [&](void* p, uintptr_t n) { total += n; recorder(p, n); });
+        CHECK(discarded == total);
+
+        for(auto &r: recorder.ranges)
+            CHECK(insideFreePayload(heap, r));
+
+        while(!heap.verifyStep(64));
+
+        const auto stats = heap.getStats();
+        const auto walked = heap.getStats(area);
+        CHECK(stats.totalFree == walked.totalFree && stats.nUsed == walked.nUsed);
+    }
+
+    for(auto ptr: live)
+        heap.free(ptr);
+
+    Recorder recorder;
+    heap.trim(area, pageSize, recorder);
+    CHECK(recorder.ranges.size() == 1);
+    CHECK(insideFreePayload(heap, recorder.ranges[0]));
+    CHECK(recorder.ranges[0].length >= sizeof(area) - 2 * pageSize);
+}
+
+TEST(Trim, TrimBlockThreshold)
+{
+    Heap heap(area, sizeof(area));
+    void* a = heap.alloc(3 * pageSize);
+    void* b = heap.alloc(100);
+    void* c = heap.alloc(20 * pageSize);
+    heap.alloc(100);
+
+    Recorder recorder;
+    CHECK(heap.trimBlock(heap.free(a), pageSize, recorder, 4 * pageSize) == 0);
+    CHECK(recorder.ranges.empty());
+
+    CHECK(heap.trimBlock(heap.free(c), pageSize, recorder, 4 * pageSize) >= 18 * pageSize);
+    CHECK(recorder.ranges.size() == 1 && insideFreePayload(heap, recorder.ranges[0]));
+
+    void* merged = heap.free(b);
+    CHECK(merged == (a < c ? a : c));
+    CHECK(heap.trimBlock(merged, pageSize, recorder, 4 * pageSize) > 0);
+    CHECK(insideFreePayload(heap, recorder.ranges.back()));
+
+    while(!heap.verifyStep(64));
+}
+
+namespace {
+
+/// Provider that records the discarded ranges.
+struct RecordingProvider: pet::MmapProvider
+{
+    static inline std::vector<Range> discarded;
+
+    static inline uintptr_t pageSize() {
+        return ::pageSize;
+    }
+
+    static inline void discard(void* ptr, uintptr_t length)
+    {
+        discarded.push_back({(uintptr_t)ptr, length});
+        memset(ptr, 0xdb, length);
+    }
+};
+
+}
+
+TEST(Trim, GrowingHeapThreshold)
+{
+    RecordingProvider::discarded.clear();
+    pet::GrowingHeap<pet::TlsfHeap<uint32_t, 3, true, true, 24>, RecordingProvider, 1 << 20, 8 * pageSize> heap;
+    std::vector<void*> blocks;
+
+    for(int i = 0; i < 40; i++)
+    {
+        blocks.push_back(heap.alloc(i % 2 ? 100 : 3 * pageSize));
+        memset(blocks[i], 0x5a, heap.getSize(blocks[i]));
+    }
+
+    // Below the threshold, even after merging with a small neighbor.
+    heap.free(blocks[10]);
+    heap.free(blocks[11]);
+    CHECK(RecordingProvider::discarded.empty());
+
+    // Above the threshold after merging.
+    heap.free(blocks[12]);
+    heap.free(blocks[13]);
+    heap.free(blocks[14]);
+    CHECK(RecordingProvider::discarded.size() >= 1);
+
+    // A single large block.
+    void* large = heap.alloc(12 * pageSize);
+    const auto nDiscarded = RecordingProvider::discarded.size();
+    heap.free(large);
+    CHECK(RecordingProvider::discarded.size() == nDiscarded + 1);
+
+    for(auto &r: RecordingProvider::discarded)
+        CHECK(r.start % pageSize == 0 && r.length % pageSize == 0 && r.length);
+
+    for(int i = 0; i < 40; i++)
+    {
+        if(i < 10 || 14 < i)
+        {
+            const auto data = static_cast<unsigned char*>(blocks[i]);
+
+            for(uintptr_t j = 0; j < heap.getSize(blocks[i]); j++)
+                CHECK(data[j] == 0x5a);
+
+            heap.free(blocks[i]);
+        }
+    }
+
+    for(int i = 0; i < 40; i++)
+    {
+        blocks[i] = heap.alloc(i % 2 ? 100 : 3 * pageSize);
+        memset(blocks[i], 0x5a, heap.getSize(blocks[i]));
+    }
+
+    for(auto ptr: blocks)
+        heap.free(ptr);
+
+    CHECK(heap.getStats().nUsed == 0);
+}
@@ -0,0 +1,226 @@
+/*******************************************************************************
+ *
+ * Copyright (c) 2026 Tamás Seller. All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *******************************************************************************/
+
+#include "1test/Test.h"
+
+#include "DebugConfig.h"
+
+#include "heap/TlsfPolicy.h"
+
+#include <vector>
+#include <random>
+
+using Heap = pet::TlsfHeap<uint32_t, 3, true>;
+
+/*
+ * Access to the internals of the heap, to place the verification cursor
+ * and to corrupt the blocks in specific ways.
+ */
+class HeapInternalsTest
+{
+public:
+    static inline void* cursor(Heap &heap) {
+        return heap.verifyCursor;
+    }
+
+    static inline void setCursor(Heap &heap, void* ptr) {
+        heap.verifyCursor = static_cast<uint32_t*>(ptr);
+    }
+
+    /// Whether the verification cursor is at the start of one of the blocks.
+    static inline bool cursorOnBoundary(Heap &heap)
+    {
+        for(Heap::Block block(heap.verifyFirst);; block = block.getNext())
+        {
+            if(block.ptr == heap.verifyCursor)
+                return true;
+
+            if(!block.hasNext(heap.end))
+                return false;
+        }
+    }
+
+    /// Mark a used block free, without merging it with its free neighbor, but with a valid checksum.
+    static inline void markFree(void* ptr)
+    {
+        const Heap::Block block(ptr);
+        block.setFree(true);
+        block.updateChecksum();
+    }
+
+    /// Make the previous link of a block inconsistent, but with a valid checksum.
+    static inline void breakPrevLink(void* ptr)
+    {
+        const Heap::Block block(ptr);
+        block.ptr[Heap::Block::prevFieldIdx]++;
+        block.updateChecksum();
+    }
+};
+
+namespace {
+
+alignas(16) char area[1 << 16];
+
+/// Run full verification passes, returning the number of failures reported.
+inline unsigned int verifyPasses(Heap &heap, int nPasses)
+{
+    ExpectFailures failures;
+
+    for(int i = 0; i < nPasses && !failures.count;)
+        if(heap.verifyStep(1))
+            i++;
+
+    return failures.count;
+}
+
+}
+
+TEST_GROUP(VerifyStep) {};
+
+TEST(VerifyStep, CursorKeptOnBoundary)
+{
+    Heap heap(area, sizeof(area));
+    std::vector<void*> live;
+    std::minstd_rand rng(17);
+    ExpectFailures failures;
+
+    for(int i = 0; i < 50000; i++)
+    {
+        const auto op = rng() % 6;
+
+        if((op == 0 || live.empty()) && live.size() < 100)
+        {
+            if(void* ptr = heap.alloc(rng() % 500 + 1))
+                live.push_back(ptr);
+        }
+        else if(op == 1)
+        {
+            const auto idx = rng() % live.size();
+            heap.free(live[idx]);
+            live[idx] = live.back();
+            live.pop_back();
+        }
+        else if(op == 2)
+        {
+            heap.resize(live[rng() % live.size()], rng() % 800 + 1);
+        }
+        else if(op == 3)
+        {
+            auto &ptr = live[rng() % live.size()];
+
+            if(void* moved = heap.reallocate(ptr, rng() % 1000 + 1))
+                ptr = moved;
+        }
+        else if(op == 4)
+        {
+            auto &ptr = live[rng() % live.size()];
+            ptr = heap.dropFront(ptr, rng() % 256);
+        }
+        else
+        {
+            heap.verifyStep(rng() % 3 + 1);
+        }
+
+        CHECK(HeapInternalsTest::cursorOnBoundary(heap));
+    }
+
+    CHECK(failures.count == 0);
+}
+
+TEST(VerifyStep, CursorMovedByMerges)
+{
+    Heap heap(area, sizeof(area));
+    void* a = heap.alloc(200);
+    void* b = heap.alloc(200);
+    void* c = heap.alloc(200);
+    void* d = heap.alloc(200);
+
+    // Released block merged into the previous free one.
+    heap.free(a);
+    HeapInternalsTest::setCursor(heap, b);
+    heap.free(b);
+    CHECK(HeapInternalsTest::cursorOnBoundary(heap));
+    CHECK(verifyPasses(heap, 2) == 0);
+
+    // Front of a used block given to the previous free one.
+    HeapInternalsTest::setCursor(heap, c);
+    c = heap.dropFront(c, 64);
+    CHECK(HeapInternalsTest::cursorOnBoundary(heap));
+    CHECK(verifyPasses(heap, 2) == 0);
+
+    // Used block moved into the previous free one (and over the next free one).
+    heap.free(d);
+    HeapInternalsTest::setCursor(heap, c);
+    c = heap.reallocate(c, 700);
+    CHECK(c != nullptr);
+    CHECK(HeapInternalsTest::cursorOnBoundary(heap));
+    CHECK(verifyPasses(heap, 2) == 0);
+}
+
+TEST(VerifyStep, DetectsCorruptedHeader)
+{
+    Heap heap(area, sizeof(area));
+    void* ptrs[20];
+
+    for(auto &p: ptrs)
+        p = heap.alloc(100);
+
+    CHECK(verifyPasses(heap, 2) == 0);
+
+    auto size = static_cast<uint32_t*>(ptrs[10]) - 1;
+    *size ^= 1;
+    CHECK(verifyPasses(heap, 1) > 0);
+    *size ^= 1;
+    CHECK(verifyPasses(heap, 2) == 0);
+
+    auto checksum = static_cast<uint32_t*>(ptrs[5]) - 3;
+    *checksum ^= 0x100;
+    CHECK(verifyPasses(heap, 1) > 0);
+    *checksum ^= 0x100;
+    CHECK(verifyPasses(heap, 2) == 0);
+}
+
+TEST(VerifyStep, DetectsUnmergedFreeBlocks)
+{
+    Heap heap(area, sizeof(area));
+    void* ptrs[20];
+
+    for(auto &p: ptrs)
+        p = heap.alloc(100);
+
+    heap.free(ptrs[7]);
+    CHECK(verifyPasses(heap, 2) == 0);
+
+    HeapInternalsTest::markFree(ptrs[8]);
+    CHECK(verifyPasses(heap, 1) > 0);
+}
+
+TEST(VerifyStep, DetectsInconsistentLinks)
+{
+    Heap heap(area, sizeof(area));
+    void* ptrs[20];
+
+    for(auto &p: ptrs)
+        p = heap.alloc(100);
+
+    CHECK(verifyPasses(heap, 2) == 0);
+
+    HeapInternalsTest::breakPrevLink(ptrs[12]);
+    CHECK(verifyPasses(heap, 1) > 0);
+}
@@ -0,0 +1,30 @@
+/*******************************************************************************
+ *
+ * Copyright (c) 2026 Tamás Seller. All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *******************************************************************************/
+
+#include "1test/Test.h"
+#include "1test/PrintfOutput.h"
+
+/*
+ * Runs the registered tests (or benchmarks), optionally only those
+ * with a name matching the wildcard pattern given as the argument.
+ */
+int main(int argc, const char* argv[])
+{
+    return pet::TestRunner::runAllTests(&pet::PrintfOutput::instance, (argc > 1) ? argv[1] : nullptr);
+}
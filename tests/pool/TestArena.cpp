@@ -0,0 +1,105 @@
+/*******************************************************************************
+ *
+ * Copyright (c) 2026 Tamás Seller. All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *******************************************************************************/
+
+#include "1test/Test.h"
+
+#include "pool/Arena.h"
+
+#include <stdlib.h>
+
+namespace {
+
+struct MallocAllocator
+{
+    static inline void* alloc(uintptr_t size) { return malloc(size); }
+    static inline void free(void* ptr) { ::free(ptr); }
+};
+
+template<class A>
+bool allAligned(A &arena, char* start, char* end, uintptr_t alignment, uintptr_t size, int n)
+{
+    for(int i = 0; i < n; i++)
+    {
+        char* ptr = static_cast<char*>(arena.alloc(size));
+
+        if(!ptr)
+            break;
+
+        if(reinterpret_cast<uintptr_t>(ptr) % alignment)
+            return false;
+
+        if(start && (ptr < start || end < ptr + size))
+            return false;
+    }
+
+    return true;
+}
+
+}
+
+TEST_GROUP(Arena) {};
+
+TEST(Arena, StaticUnalignedEnd)
+{
+    alignas(8) char buffer[100];
+    pet::Arena<> arena(buffer, sizeof(buffer));
+
+    CHECK(allAligned(arena, buffer, buffer + sizeof(buffer), sizeof(void*), 1, 200));
+    CHECK(arena.alloc(1) == nullptr);
+}
+
+TEST(Arena, StaticLargeAlignment)
+{
+    alignas(8) char buffer[70];
+    pet::Arena<pet::NullAllocator, 1024, 64> arena(buffer, sizeof(buffer));
+
+    CHECK(allAligned(arena, buffer, buffer + sizeof(buffer), 64, 1, 10));
+    CHECK(arena.alloc(1) == nullptr);
+}
+
+TEST(Arena, OwnedChunks)
+{
+    pet::Arena<MallocAllocator, 64, 16> arena;
+
+    for(uintptr_t size = 1; size < 100; size++)
+    {
+        CHECK(allAligned(arena, nullptr, nullptr, 16, size, 5));
+    }
+
+    CHECK(arena.alloc(uintptr_t(-1) - 8) == nullptr);
+}
+
+TEST(Arena, Rewind)
+{
+    alignas(8) char buffer[256];
+    pet::Arena<MallocAllocator, 64> arena(buffer, sizeof(buffer));
+
+    void* a = arena.alloc(16);
+    const auto marker = arena.mark();
+    void* b = arena.alloc(16);
+
+    for(int i = 0; i < 100; i++)
+        CHECK(arena.alloc(40));
+
+    arena.rewind(marker);
+    CHECK(arena.alloc(16) == b);
+
+    arena.reset();
+    CHECK(arena.alloc(16) == a);
+}
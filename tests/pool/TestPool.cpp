@@ -0,0 +1,195 @@
+/*******************************************************************************
+ *
+ * Copyright (c) 2026 Tamás Seller. All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *******************************************************************************/
+
+#include "1test/Test.h"
+
+#include "pool/Pool.h"
+#include "pool/DynamicPool.h"
+#include "pool/StaticAllocator.h"
+
+#include "managed/Unique.h"
+#include "managed/RefCnt.h"
+#include "managed/TreeMap.h"
+
+#include "heap/TlsfPolicy.h"
+
+#include <stdlib.h>
+
+namespace {
+
+/// Slot storage for the objects of the managed pointer tests (which need the pool to be declared first).
+struct alignas(16) Storage
+{
+    char bytes[64];
+};
+
+pet::Pool<Storage, 2> uniquePool;
+pet::Pool<Storage, 2> refCntPool;
+
+int nAlive;
+
+struct Owned: pet::Unique<Owned, pet::StaticAllocator<uniquePool>>
+{
+    int value;
+    inline Owned(int value): value(value) { nAlive++; }
+    inline ~Owned() { nAlive--; }
+};
+
+struct Shared: pet::RefCnt<Shared, pet::StaticAllocator<refCntPool>>
+{
+    int value;
+    inline Shared(int value): value(value) { nAlive++; }
+    inline ~Shared() { nAlive--; }
+};
+
+/// Backing allocator that counts the slabs allocated and released.
+struct CountingAllocator
+{
+    static inline int nAllocated, nReleased;
+    static inline void* alloc(uintptr_t size) { nAllocated++; return malloc(size); }
+    static inline void free(void* ptr) { nReleased++; ::free(ptr); }
+};
+
+alignas(16) char area[1024];
+pet::TlsfHeap<uint32_t, 3> heap(area, sizeof(area));
+pet::DynamicPool<Storage, pet::StaticAllocator<heap>, 4> heapBackedPool;
+
+struct Pooled: pet::Unique<Pooled, pet::StaticAllocator<heapBackedPool>>
+{
+    int value;
+    inline Pooled(int value): value(value) {}
+};
+
+}
+
+TEST_GROUP(Pool) {};
+
+TEST(Pool, UniqueFromStaticPool)
+{
+    {
+        auto a = Owned::make(1);
+        auto b = Owned::make(2);
+        CHECK(a && b && a->value == 1 && b->value == 2);
+        CHECK(!Owned::make(3));
+        CHECK(nAlive == 2);
+
+        a = nullptr;
+        CHECK(nAlive == 1);
+
+        auto c = Owned::make(4);
+        CHECK(c && c->value == 4 && b->value == 2);
+    }
+
+    CHECK(nAlive == 0);
+    CHECK(uniquePool.alloc(1) && uniquePool.alloc(1) && !uniquePool.alloc(1));
+}
+
+TEST(Pool, RefCntFromStaticPool)
+{
+    {
+        auto a = Shared::make(1);
+        auto b = Shared::make(2);
+        CHECK(a && b && !Shared::make(3));
+
+        {
+            Shared::Ptr<> c(a);
+            a = nullptr;
+            CHECK(nAlive == 2);
+            CHECK(c->value == 1);
+        }
+
+        CHECK(nAlive == 1);
+
+        auto d = Shared::make(5);
+        CHECK(d && d->value == 5 && b->value == 2);
+    }
+
+    CHECK(nAlive == 0);
+}
+
+TEST(Pool, TreeMapExhaustion)
+{
+    using Node = pet::ImmutableTreeMap<int, int>::Node;
+    pet::TreeMap<int, int, pet::Pool<Node, 8>> map;
+
+    for(int i = 0; i < 8; i++)
+        CHECK(map.put(i, 10 * i));
+
+    CHECK(!map.put(8, 80));
+    CHECK(!map.contains(8));
+    CHECK(map.put(3, 33));
+
+    CHECK(map.remove(5));
+    CHECK(map.put(8, 80));
+    CHECK(!map.put(9, 90));
+
+    for(int i = 0; i < 9; i++)
+    {
+        const auto value = map.get(i);
+        CHECK(i == 5 ? !value : value && *value == (i == 3 ? 33 : 10 * i));
+    }
+}
+
+TEST(Pool, DynamicPoolSlabs)
+{
+    CountingAllocator::nAllocated = CountingAllocator::nReleased = 0;
+
+    {
+        pet::DynamicPool<Storage, CountingAllocator, 4> pool;
+        void* ptrs[10];
+
+        for(auto &p: ptrs)
+            CHECK((p = pool.alloc(sizeof(Storage))) != nullptr);
+
+        CHECK(CountingAllocator::nAllocated == 3);
+        CHECK(!pool.alloc(sizeof(Storage) + 1));
+
+        for(auto p: ptrs)
+            pool.free(p);
+
+        for(auto &p: ptrs)
+            CHECK((p = pool.allocFor<Storage>()) != nullptr);
+
+        CHECK(CountingAllocator::nAllocated == 3);
+        CHECK(CountingAllocator::nReleased == 0);
+    }
+
+    CHECK(CountingAllocator::nReleased == 3);
+}
+
+TEST(Pool, DynamicPoolOnHeap)
+{
+    {
+        Pooled::Ptr<> ptrs[40];
+        int n = 0;
+
+        while(n < 40 && (ptrs[n] = Pooled::make(n)))
+            n++;
+
+        CHECK(0 < n && n < 40);
+
+        for(int i = 0; i < n; i++)
+            CHECK(ptrs[i]->value == i);
+
+        ptrs[0] = nullptr;
+        CHECK((ptrs[0] = Pooled::make(100)) && ptrs[0]->value == 100);
+    }
+
+    CHECK(heapBackedPool.alloc(sizeof(Storage)) != nullptr);
+}